@@ -0,0 +1,185 @@
+#ifndef __CLOCK_FOLLOWER_H
+#define __CLOCK_FOLLOWER_H
+
+#include <stdint.h>
+
+/**
+ * CLOCK FOLLOWER
+ *
+ * Follows an external (quarter note) clock, generating the PPQN ticks between each pulse.
+ *
+ * Every incoming edge gets timestamped, and the time between edges is filtered to smooth out jitter in the
+ * incoming clock. Each edge emits the downbeat tick of a new beat, and the remaining PPQN - 1 ticks get spread
+ * evenly over the filtered period by a timer. Tick times are absolute (relative to the edge) and the fractional
+ * part of period / PPQN is carried from tick to tick, so timer latency never accumulates into drift.
+ *
+ * Exactly PPQN ticks get emitted per beat, no matter how the incoming clock moves:
+ *  - if an edge arrives before all of the previous beats ticks were emitted (clock sped up), the missing ticks
+ *    are emitted immediately, ahead of the new downbeat
+ *  - once all of a beats ticks have been emitted, nothing more happens until the next edge (clock slowed down)
+ *  - if no edge arrives for 1.5 periods, the clock is considered stopped and the follower keeps running at the
+ *    last tempo (holding) until edges come back. An edge arriving shortly after the held downbeat is taken to be that
+ *    (late) downbeat rather than a new one, so a sudden drop in tempo does not add a beat
+ *
+ * The follower does not know anything about timers or interrupts - edge() and expire() return how many ticks
+ * are due, and nextEventTime / timerArmed say when expire() should be called next.
+*/
+class ClockFollower {
+public:
+  int ppqn;
+  uint32_t minPeriod;       // edges closer together than this (in us) are ignored as noise / switch bounce
+  uint32_t maxPeriod;       // periods longer than this do not get measured (ie. the first edge after a dropout)
+
+  uint32_t period;          // filtered time between edges (us)
+  uint32_t lastEdge;        // timestamp of the current beats downbeat (us)
+  uint32_t lastRealEdge;    // timestamp of the last edge received (us)
+  int virtualBeats;         // number of downbeats emitted while holding, since the last edge
+  uint32_t nextEventTime;   // when expire() is due next (us)
+  bool timerArmed;          // false when there is nothing to do until the next edge
+  bool hasEdge;             // an edge has been seen (but maybe not a period)
+  bool locked;              // a period has been measured, ticks are being generated
+  bool holding;             // the external clock has stopped, ticks are running at the last measured tempo
+  int ticksThisBeat;        // ticks emitted so far in the current beat (including the downbeat)
+
+  uint32_t tickInterval;    // whole us between ticks (period / ppqn)
+  uint32_t tickRemainder;   // period % ppqn, carried between ticks
+  uint32_t remainderAcc;
+
+  uint32_t ticksEmitted;    // total ticks emitted
+  uint32_t catchUpTicks;    // ticks which had to be emitted early because an edge arrived before they were due
+  uint32_t dropouts;        // number of times the external clock stopped
+
+  ClockFollower(int _ppqn, uint32_t _minPeriod, uint32_t _maxPeriod) {
+    ppqn = _ppqn;
+    minPeriod = _minPeriod;
+    maxPeriod = _maxPeriod;
+    reset();
+  }
+
+  void reset() {
+    period = 0;
+    hasEdge = false;
+    locked = false;
+    holding = false;
+    virtualBeats = 0;
+    timerArmed = false;
+    ticksThisBeat = 0;
+    ticksEmitted = 0;
+    catchUpTicks = 0;
+    dropouts = 0;
+  }
+
+  /**
+   * call on every rising edge of the external clock, returns the number of ticks to emit right now
+  */
+  int edge(uint32_t now) {
+    if (!hasEdge) {
+      hasEdge = true;
+      lastEdge = now;
+      lastRealEdge = now;
+      return 0;
+    }
+
+    uint32_t measured = now - lastRealEdge;
+    if (measured < minPeriod) {
+      return 0;
+    }
+    lastRealEdge = now;
+
+    if (virtualBeats <= 1 && measured <= maxPeriod) { // don't measure across a dropout
+      if (!locked || measured > period + (period >> 3) || measured < period - (period >> 3)) {
+        period = measured;                        // big tempo change, jump straight to it
+      } else {
+        period = (period * 3 + measured) >> 2;    // filter out the jitter
+      }
+    }
+    if (period == 0) {                            // no period measured yet
+      lastEdge = now;
+      return 0;
+    }
+
+    // the clock slowed down enough to be mistaken for a dropout, and this edge is the downbeat which was
+    // already emitted. Don't emit it again, just re-time the rest of the beat from here
+    bool lateDownbeat = holding && virtualBeats == 1 && now - lastEdge < (period >> 1);
+    holding = false;
+    virtualBeats = 0;
+    if (lateDownbeat) {
+      int emitted = ticksThisBeat;
+      startBeat(now);
+      ticksThisBeat = emitted;
+      if (ticksThisBeat >= ppqn) {
+        nextEventTime = lastEdge + period + (period >> 1);
+      }
+      return 0;
+    }
+
+    int ticks = 0;
+    if (locked) {
+      ticks = ppqn - ticksThisBeat;               // whatever is left of the previous beat
+      catchUpTicks += ticks;
+    }
+    locked = true;
+    startBeat(now);
+    ticks += 1;                                   // the downbeat
+    ticksEmitted += ticks;
+    return ticks;
+  }
+
+  /**
+   * call once now >= nextEventTime, returns the number of ticks to emit right now (0 or 1)
+  */
+  int expire(uint32_t now) {
+    if (!timerArmed) {
+      return 0;
+    }
+    if (ticksThisBeat < ppqn) {
+      ticksThisBeat += 1;
+      ticksEmitted += 1;
+      if (ticksThisBeat < ppqn) {
+        scheduleNextTick();
+      } else if (holding) {
+        nextEventTime = lastEdge + period;        // the next (virtual) downbeat
+      } else {
+        nextEventTime = lastEdge + period + (period >> 1); // wait for the next edge, or give up on it
+      }
+      return 1;
+    }
+
+    // all ticks of the beat are done, and no edge arrived
+    virtualBeats += 1;
+    if (!holding) {
+      holding = true;
+      dropouts += 1;
+      startBeat(now);
+    } else {
+      startBeat(lastEdge + period);
+    }
+    ticksEmitted += 1;
+    return 1;
+  }
+
+private:
+
+  // emit the downbeat of a new beat at 'time', and schedule the ticks which follow
+  void startBeat(uint32_t time) {
+    lastEdge = time;
+    ticksThisBeat = 1;
+    tickInterval = period / ppqn;
+    tickRemainder = period % ppqn;
+    remainderAcc = 0;
+    nextEventTime = time;
+    timerArmed = true;
+    scheduleNextTick();
+  }
+
+  void scheduleNextTick() {
+    nextEventTime += tickInterval;
+    remainderAcc += tickRemainder;
+    if (remainderAcc >= (uint32_t)ppqn) {
+      remainderAcc -= ppqn;
+      nextEventTime += 1;
+    }
+  }
+};
+
+#endif
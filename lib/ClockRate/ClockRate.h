@@ -0,0 +1,48 @@
+#ifndef __CLOCK_RATE_H
+#define __CLOCK_RATE_H
+
+#include <stdint.h>
+
+/**
+ * CLOCK RATE
+ *
+ * Scales an incoming clock by a rational rate (numerator / denominator), ie. 1/4x, 1/2x, 2x, 4x etc.
+ *
+ * The phase accumulator counts in 1/denominator's of an output tick. Every input tick adds the numerator, and
+ * every whole output tick which has accumulated gets emitted. Being integer, there is no rounding error - after
+ * any multiple of 'denominator' input ticks exactly 'numerator' output ticks have been emitted, so a scaled channel
+ * stays phase locked to the master clock no matter how long it runs.
+*/
+class ClockRate {
+public:
+  uint8_t numerator;
+  uint8_t denominator;
+  uint16_t phase;         // 0..denominator-1
+
+  ClockRate() {
+    set(1, 1);
+  }
+
+  void set(uint8_t num, uint8_t den) {
+    numerator = num;
+    denominator = den;
+    phase = 0;
+  }
+
+  bool isUnity() { return numerator == denominator; }
+
+  /**
+   * advance by one input tick, returning how many output ticks elapsed (0..numerator)
+  */
+  int tick() {
+    int ticks = 0;
+    phase += numerator;
+    while (phase >= denominator) {
+      phase -= denominator;
+      ticks += 1;
+    }
+    return ticks;
+  }
+};
+
+#endif
@@ -0,0 +1,134 @@
+#ifndef __DAC_FRAME_H
+#define __DAC_FRAME_H
+
+#include <stdint.h>
+
+#define DAC_FRAME_CHIPS 2                          // DAC8554s sharing the bus
+#define DAC_FRAME_CHANNELS 4                       // outputs per DAC8554
+#define DAC_FRAME_MAX_COMMANDS (DAC_FRAME_CHIPS * DAC_FRAME_CHANNELS + 1)
+
+/**
+ * One 24-bit DAC8554 write, and which chip(s) to select for it
+*/
+typedef struct DacCommand {
+  uint8_t chips;      // bit per chip, chip 0 == bit 0
+  uint32_t word;      // control byte << 16 | data
+} DacCommand;
+
+/**
+ * DAC FRAME
+ *
+ * Collects every DAC output value written during one pass of the main loop, and turns them into the DAC8554 commands
+ * which make all of them change at the same instant.
+ *
+ * DAC8554 control byte (DB23 - DB16): A1 A0 LD1 LD0 X SEL1 SEL0 PD0
+ *   LD = 00  store     - write the channels buffer, output does not change
+ *   LD = 10  load all  - write the channels buffer, then update all four outputs from their buffers
+ *   LD = 11  broadcast - (SEL1 = 0) every chip selected updates all four outputs from their buffers
+ *
+ * Only the outputs written since the last flush get sent. They are all stored into their buffers, and the last one of
+ * them doubles as the load of its whole chip. When outputs on more than one chip changed, every chip gets loaded at
+ * once instead, by a single broadcast with all of their chip selects held low together.
+ *
+ * Writing an output several times in one pass only sends the last value, so the number of SPI transactions is the
+ * number of outputs which changed (plus one when more than one chip changed), rather than the number of writes.
+ *
+ * DIRTY CHECKING
+ * The frame remembers the value each output holds (or will hold once flushed). Writing an output the value it
+ * already has is dropped and counted in writesAvoided, so channels can rewrite their outputs every tick for free.
+ * Anything which writes a DAC behind the frames back must invalidate() the output afterwards.
+*/
+class DacFrame {
+public:
+  enum Mode {
+    STORE = 0x00,
+    LOAD_ALL = 0x20,
+    BROADCAST_LOAD = 0x30
+  };
+
+  uint16_t values[DAC_FRAME_CHIPS][DAC_FRAME_CHANNELS];
+  uint8_t dirty[DAC_FRAME_CHIPS];    // bit per channel written since the last flush
+  uint8_t known[DAC_FRAME_CHIPS];    // bit per channel whose value is known to be on (or on its way to) the DAC
+  uint32_t writes;                   // number of write() calls
+  uint32_t writesAvoided;            // number of write() calls dropped because the output already had the value
+  uint32_t transactions;             // number of commands built
+
+  DacFrame() {
+    for (int chip = 0; chip < DAC_FRAME_CHIPS; chip++) {
+      dirty[chip] = 0;
+      known[chip] = 0;
+      for (int chan = 0; chan < DAC_FRAME_CHANNELS; chan++) {
+        values[chip][chan] = 0;
+      }
+    }
+    writes = 0;
+    writesAvoided = 0;
+    transactions = 0;
+  }
+
+  /**
+   * returns false when the output already has 'value', and nothing needs sending
+  */
+  bool write(int chip, int chan, uint16_t value) {
+    writes += 1;
+    if ((known[chip] & (1 << chan)) && values[chip][chan] == value) {
+      writesAvoided += 1;
+      return false;
+    }
+    values[chip][chan] = value;
+    dirty[chip] |= 1 << chan;
+    known[chip] |= 1 << chan;
+    return true;
+  }
+
+  /**
+   * forget what an output holds, so the next write() to it always gets sent
+  */
+  void invalidate(int chip, int chan) {
+    known[chip] &= ~(1 << chan);
+  }
+
+  bool isDirty() {
+    for (int chip = 0; chip < DAC_FRAME_CHIPS; chip++) {
+      if (dirty[chip]) return true;
+    }
+    return false;
+  }
+
+  /**
+   * fill 'commands' (at least DAC_FRAME_MAX_COMMANDS long) with the writes needed to output this frame, in the order
+   * they must be sent. Returns the number of commands, and starts a new frame
+  */
+  int flush(DacCommand *commands) {
+    int count = 0;
+    int chipsChanged = 0;
+    for (int chip = 0; chip < DAC_FRAME_CHIPS; chip++) {
+      if (!dirty[chip]) continue;
+      chipsChanged += 1;
+      for (int chan = 0; chan < DAC_FRAME_CHANNELS; chan++) {
+        if (dirty[chip] & (1 << chan)) {
+          commands[count].chips = 1 << chip;
+          commands[count].word = command(STORE, chan, values[chip][chan]);
+          count += 1;
+        }
+      }
+      dirty[chip] = 0;
+    }
+
+    if (chipsChanged == 1) {
+      commands[count - 1].word |= (uint32_t)LOAD_ALL << 16;        // the last store loads its chip
+    } else if (chipsChanged > 1) {
+      commands[count].chips = (1 << DAC_FRAME_CHIPS) - 1;
+      commands[count].word = (uint32_t)BROADCAST_LOAD << 16;
+      count += 1;
+    }
+    transactions += count;
+    return count;
+  }
+
+  static uint32_t command(Mode mode, int chan, uint16_t value) {
+    return ((uint32_t)(mode | (chan << 1)) << 16) | value;
+  }
+};
+
+#endif
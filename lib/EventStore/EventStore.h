@@ -0,0 +1,190 @@
+#ifndef __EVENT_STORE_H
+#define __EVENT_STORE_H
+
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * A single sequencer event. The events position in the loop is not stored in the node itself,
+ * it is held by the EventStore index which points to the node.
+*/
+typedef struct SequenceNode {
+  uint8_t activeNotes; // byte for holding active/inactive notes for a chord
+  uint8_t noteIndex;   // note index between 0 and 7
+  bool gate;           // set gate HIGH or LOW
+  uint8_t offset;      // when the event happens within its tick, in 1/256ths of a tick (sub-tick timing)
+  uint16_t generation; // stamped by the EventStore every time the node is allocated or removed
+} SequenceNode;
+
+/**
+ * A reference to a node which can safely be held on to across inserts, removals and clears.
+ * EventStore::resolve() returns NULL once the node it points to has been removed or cleared.
+*/
+typedef struct EventRef {
+  uint16_t slot;
+  uint16_t generation;
+} EventRef;
+
+/**
+ * EVENT STORE
+ *
+ * A compact, position sorted container for sequence events. Memory scales with the number of events
+ * recorded (CAPACITY) rather than with the length of the loop (PPQN * MAX_SEQ_STEPS).
+ *
+ * nodes are held in a fixed size pool, and a sorted index of { position, slot } pairs points into that pool.
+ * Pool slots never move once allocated, so a SequenceNode pointer stays valid until its event gets removed.
+ *
+ * Lookup is a binary search over the index: O(log n) where n is the number of recorded events
+ *
+ * GENERATIONS
+ * Every allocation / removal stamps the node with the next generation number, and clear() only records the
+ * generation it happened at (the epoch) before resetting the index and pool allocator. This makes clearing a
+ * sequence O(1), no matter how many events it holds - nodes from before the clear are simply treated as stale,
+ * and their pool slots get recycled as new events are created.
+*/
+template <int CAPACITY>
+class EventStore {
+public:
+
+  typedef struct IndexEntry {
+    uint16_t position;     // the position (in PPQN) of the event within the loop
+    uint16_t slot;         // index of the node in the pool
+  } IndexEntry;
+
+  SequenceNode nodes[CAPACITY];  // the node pool
+  IndexEntry index[CAPACITY];    // position sorted index into node pool
+  uint16_t freeSlots[CAPACITY];  // stack of removed pool slots, waiting to be re-used
+  int length;                    // number of events currently in the store
+  int numFreeSlots;              // number of slots on the free stack
+  int numAllocated;              // pool slots at or above this index have not been used since the last clear
+  uint16_t generation;           // incremented every time a node gets allocated or removed
+  uint16_t epoch;                // the generation at which the store was last cleared
+
+  EventStore() {
+    generation = 0;
+    clear();
+  }
+
+  void clear() {
+    length = 0;
+    numFreeSlots = 0;
+    numAllocated = 0;
+    epoch = generation;
+  }
+
+  /**
+   * make this store an exact copy of another, including its node generations, so any EventRef
+   * held against the other store resolves to the same event in this one. Only the used part of the pool is copied
+  */
+  void copyFrom(const EventStore &other) {
+    length = other.length;
+    numFreeSlots = other.numFreeSlots;
+    numAllocated = other.numAllocated;
+    generation = other.generation;
+    epoch = other.epoch;
+    memcpy(nodes, other.nodes, numAllocated * sizeof(SequenceNode));
+    memcpy(index, other.index, length * sizeof(IndexEntry));
+    memcpy(freeSlots, other.freeSlots, numFreeSlots * sizeof(uint16_t));
+  }
+
+  int size() { return length; }
+  int capacity() { return CAPACITY; }
+  bool isEmpty() { return length == 0; }
+  bool isFull() { return length >= CAPACITY; }
+
+  /**
+   * returns the index of the first event whose position is >= position (or size() if there is none)
+  */
+  int lowerBound(int position) {
+    int low = 0;
+    int high = length;
+    while (low < high) {
+      int mid = (low + high) >> 1;
+      if (index[mid].position < position) {
+        low = mid + 1;
+      } else {
+        high = mid;
+      }
+    }
+    return low;
+  }
+
+  /**
+   * returns a pointer to the node at the given position, or NULL if no event exists there
+  */
+  SequenceNode *find(int position) {
+    int i = lowerBound(position);
+    if (i < length && index[i].position == position) {
+      return &nodes[index[i].slot];
+    }
+    return NULL;
+  }
+
+  /**
+   * returns the node at the given position, creating one if it does not exist yet.
+   * returns NULL when a new node is required but the pool is exhausted
+  */
+  SequenceNode *insert(int position) {
+    int i = lowerBound(position);
+    if (i < length && index[i].position == position) {
+      return &nodes[index[i].slot];
+    }
+
+    uint16_t slot;
+    if (numFreeSlots > 0) {
+      slot = freeSlots[--numFreeSlots];
+    } else if (numAllocated < CAPACITY) {
+      slot = numAllocated++;
+    } else {
+      return NULL;
+    }
+
+    nodes[slot].generation = generation++;
+    memmove(&index[i + 1], &index[i], (length - i) * sizeof(IndexEntry)); // make room in the index
+    index[i].position = position;
+    index[i].slot = slot;
+    length += 1;
+    return &nodes[slot];
+  }
+
+  /**
+   * remove the event at the given position, returning its pool slot to the free stack
+  */
+  bool remove(int position) {
+    int i = lowerBound(position);
+    if (i >= length || index[i].position != position) {
+      return false;
+    }
+    nodes[index[i].slot].generation = generation++;  // invalidate any references to this node
+    freeSlots[numFreeSlots++] = index[i].slot;
+    memmove(&index[i], &index[i + 1], (length - i - 1) * sizeof(IndexEntry));
+    length -= 1;
+    return true;
+  }
+
+  int positionAt(int i) { return index[i].position; }
+  SequenceNode *nodeAt(int i) { return &nodes[index[i].slot]; }
+
+  EventRef ref(SequenceNode *node) {
+    EventRef ref;
+    ref.slot = node - nodes;
+    ref.generation = node->generation;
+    return ref;
+  }
+
+  /**
+   * returns the node being referenced, or NULL if it has since been removed or the store has been cleared
+  */
+  SequenceNode *resolve(EventRef ref) {
+    if (ref.slot >= numAllocated) {
+      return NULL;
+    }
+    if ((uint16_t)(ref.generation - epoch) >= (uint16_t)(generation - epoch)) { // allocated before the last clear
+      return NULL;
+    }
+    SequenceNode *node = &nodes[ref.slot];
+    return node->generation == ref.generation ? node : NULL;
+  }
+};
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef __EVENT_STORE_POOL_H
+#define __EVENT_STORE_POOL_H
+
+#include <stdint.h>
+#include "EventStore.h"
+
+/**
+ * EVENT STORE POOL
+ *
+ * A fixed set of reference counted EventStores shared between channels. Copying a sequence to another channel
+ * only hands the destination a reference to the same store (copy-on-write), so a pasted loop costs no RAM and
+ * no copying until one of the channels writes to it. At that point makeWritable() gives the writer its own copy.
+ *
+ * With one store per channel in the pool, a free store is always available when a shared one needs duplicating:
+ * if any store is shared by two or more channels, fewer than POOL_SIZE stores can be in use.
+*/
+template <int CAPACITY, int POOL_SIZE>
+class EventStorePool {
+public:
+  typedef EventStore<CAPACITY> Store;
+
+  Store stores[POOL_SIZE];
+  uint8_t refCounts[POOL_SIZE];   // number of channels using each store (0 == free)
+
+  EventStorePool() {
+    for (int i = 0; i < POOL_SIZE; i++) {
+      refCounts[i] = 0;
+    }
+  }
+
+  /**
+   * returns an empty store with a reference count of 1, or NULL if every store is in use
+  */
+  Store *acquire() {
+    for (int i = 0; i < POOL_SIZE; i++) {
+      if (refCounts[i] == 0) {
+        refCounts[i] = 1;
+        stores[i].clear();
+        return &stores[i];
+      }
+    }
+    return NULL;
+  }
+
+  void retain(Store *store) {
+    refCounts[store - stores] += 1;
+  }
+
+  void release(Store *store) {
+    if (refCounts[store - stores] > 0) {
+      refCounts[store - stores] -= 1;
+    }
+  }
+
+  int refCount(Store *store) { return refCounts[store - stores]; }
+  bool isShared(Store *store) { return refCount(store) > 1; }
+  int numFree() {
+    int count = 0;
+    for (int i = 0; i < POOL_SIZE; i++) {
+      if (refCounts[i] == 0) count++;
+    }
+    return count;
+  }
+
+  /**
+   * returns a store which can be safely written to: the store itself if it is not shared, otherwise a private copy
+   * of it (the callers reference to the shared store gets released). Returns NULL if no free store was available
+  */
+  Store *makeWritable(Store *store) {
+    if (!isShared(store)) {
+      return store;
+    }
+    Store *copy = acquire();
+    if (!copy) {
+      return NULL;
+    }
+    copy->copyFrom(*store);
+    release(store);
+    return copy;
+  }
+};
+
+#endif
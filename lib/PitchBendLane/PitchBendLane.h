@@ -0,0 +1,196 @@
+#ifndef __PITCH_BEND_LANE_H
+#define __PITCH_BEND_LANE_H
+
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * PITCH BEND AUTOMATION LANE
+ *
+ * Stores pitch bend as a list of breakpoints rather than a value for every PPQN position. A new breakpoint only
+ * gets added while recording when the incoming value has moved further than the debounce threshold from the last
+ * recorded breakpoint, so storage grows with the number of bend movements, not the length of the loop.
+ *
+ * On playback, values between two breakpoints are linearly interpolated. The slope of each segment is
+ * pre-computed (Q16 fixed point) whenever the breakpoints change, so valueAt() does not need to divide.
+ *
+ * Positions with no automation (before the first breakpoint) output the idleValue (ie. pbZero)
+*/
+template <int CAPACITY>
+class PitchBendLane {
+public:
+
+  typedef struct Breakpoint {
+    uint16_t position;   // the position (in PPQN) of the breakpoint within the loop
+    uint16_t value;      // raw ADC pitch bend value
+    int32_t slope;       // Q16 change in value per PPQN until the next breakpoint
+  } Breakpoint;
+
+  Breakpoint points[CAPACITY];
+  int length;
+  uint16_t idleValue;          // the value used where no bend has been recorded
+
+  bool recording;              // true while a bend is being recorded
+  int prevPosition;            // position of the last recorded sample
+  uint16_t prevValue;          // value of the last recorded sample
+  int lastBreakpointPosition;  // position of the last breakpoint added while recording
+  uint16_t lastBreakpointValue;// value of the last breakpoint added while recording
+  Breakpoint resumePoint;      // copy of the last pre-existing breakpoint overwritten by the current recording
+  bool hasResumePoint;         // false when there was no pre-existing automation to resume to
+
+  PitchBendLane() {
+    clear(0);
+  }
+
+  void clear(uint16_t idle) {
+    length = 0;
+    idleValue = idle;
+    recording = false;
+  }
+
+  int size() { return length; }
+  bool isEmpty() { return length == 0; }
+
+  /**
+   * record a pitch bend sample. Any existing breakpoints between the previous sample and this one get overwritten.
+  */
+  void record(int position, uint16_t value, int threshold) {
+    if (!recording) {
+      recording = true;
+      int i = upperBound(position) - 1;
+      hasResumePoint = i >= 0;
+      if (hasResumePoint) resumePoint = points[i];
+      if (position > 0) {
+        addBreakpoint(position - 1, resumeValue(position - 1)); // hold any existing automation right up until the new recording
+      }
+      addBreakpoint(position, value);
+    } else {
+      bool wrapped = position < prevPosition;
+      eraseTo(position);
+      if (wrapped) {
+        addBreakpoint(position, value);
+      } else if (value > lastBreakpointValue + threshold || value < lastBreakpointValue - threshold) {
+        addBreakpoint(position, value);
+      }
+    }
+    prevPosition = position;
+    prevValue = value;
+  }
+
+  /**
+   * finish the current recording at the given position, and resume any pre-existing automation from there
+  */
+  void endRecording(int position) {
+    if (!recording) return;
+    recording = false;
+
+    if (prevPosition != lastBreakpointPosition) {
+      addBreakpoint(prevPosition, prevValue);      // hold the last recorded value up until now
+    }
+    eraseTo(position);
+    addBreakpoint(position, resumeValue(position));
+  }
+
+  /**
+   * get the (interpolated) pitch bend value for the given position
+  */
+  uint16_t valueAt(int position) {
+    int i = upperBound(position) - 1;  // last breakpoint at or before position
+    if (i < 0) {
+      return idleValue;
+    }
+    return interpolate(points[i], position);
+  }
+
+private:
+
+  // returns the index of the first breakpoint whose position is > position
+  int upperBound(int position) {
+    int low = 0;
+    int high = length;
+    while (low < high) {
+      int mid = (low + high) >> 1;
+      if (points[mid].position <= position) {
+        low = mid + 1;
+      } else {
+        high = mid;
+      }
+    }
+    return low;
+  }
+
+  uint16_t interpolate(Breakpoint &point, int position) {
+    int32_t value = point.value + (int32_t)(((int64_t)point.slope * (position - point.position)) >> 16);
+    if (value < 0) value = 0;
+    if (value > 0xFFFF) value = 0xFFFF;
+    return value;
+  }
+
+  // the value the automation had at position before the current recording started overwriting it
+  uint16_t resumeValue(int position) {
+    return hasResumePoint ? interpolate(resumePoint, position) : idleValue;
+  }
+
+  // erase everything after the previous sample up to and including position, handling the loop wrapping
+  void eraseTo(int position) {
+    if (position < prevPosition) {
+      if (prevPosition != lastBreakpointPosition) {
+        addBreakpoint(prevPosition, prevValue);    // hold the bend up until the end of the loop
+      }
+      eraseRange(prevPosition + 1, 0xFFFF);
+      hasResumePoint = false;                      // nothing before position 0
+      eraseRange(0, position);
+    } else {
+      eraseRange(prevPosition + 1, position);
+    }
+  }
+
+  void addBreakpoint(int position, uint16_t value) {
+    lastBreakpointPosition = position;
+    lastBreakpointValue = value;
+
+    int i = upperBound(position);
+    if (i > 0 && points[i - 1].position == position) {   // overwrite existing breakpoint
+      points[i - 1].value = value;
+      updateSlope(i - 2);
+      updateSlope(i - 1);
+      return;
+    }
+    if (length >= CAPACITY) {
+      return; // lane is full, drop the breakpoint
+    }
+    memmove(&points[i + 1], &points[i], (length - i) * sizeof(Breakpoint));
+    points[i].position = position;
+    points[i].value = value;
+    length += 1;
+    updateSlope(i - 1);
+    updateSlope(i);
+  }
+
+  // remove all breakpoints with a position between start and end (inclusive)
+  void eraseRange(int start, int end) {
+    if (end < start) return;
+    int first = upperBound(start - 1);
+    int last = upperBound(end);
+    if (last <= first) return;
+    resumePoint = points[last - 1];                // slope still points at the next pre-existing breakpoint
+    hasResumePoint = true;
+    memmove(&points[first], &points[last], (length - last) * sizeof(Breakpoint));
+    length -= last - first;
+    updateSlope(first - 1);
+  }
+
+  void updateSlope(int i) {
+    if (i < 0 || i >= length) return;
+    if (i == length - 1) {
+      points[i].slope = 0;                         // hold the last value
+      return;
+    }
+    int64_t slope = ((int64_t)(points[i + 1].value - points[i].value) << 16) / (points[i + 1].position - points[i].position);
+    if (slope > INT32_MAX) slope = INT32_MAX;
+    if (slope < INT32_MIN) slope = INT32_MIN;
+    points[i].slope = slope;
+  }
+};
+
+#endif
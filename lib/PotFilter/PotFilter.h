@@ -0,0 +1,51 @@
+#ifndef __POT_FILTER_H
+#define __POT_FILTER_H
+
+#include <stdint.h>
+
+/**
+ * POT FILTER
+ *
+ * Smooths out the noise on a potentiometer reading (a 16-bit ADC value). Readings go through a single pole IIR
+ * low pass filter (each new reading moves the filtered value 1 / 2^SHIFT of the way towards it), and the output
+ * only changes once the filtered value has moved more than 'hysteresis' away from it - so a pot which is sitting
+ * still does not flicker between two values.
+*/
+template <int SHIFT>
+class PotFilter {
+public:
+  int32_t filtered;     // the filtered value, with SHIFT bits of fraction
+  uint16_t output;      // the last value reported by update()
+  uint16_t hysteresis;
+  bool primed;          // false until the first reading
+
+  PotFilter(uint16_t _hysteresis) {
+    hysteresis = _hysteresis;
+    primed = false;
+    output = 0;
+    filtered = 0;
+  }
+
+  /**
+   * feed in a new reading. Returns true when 'output' has changed
+  */
+  bool update(uint16_t reading) {
+    int32_t target = (int32_t)reading << SHIFT;
+    if (!primed) {
+      primed = true;
+      filtered = target;
+      output = reading;
+      return true;
+    }
+    filtered += (target - filtered) >> SHIFT;
+
+    int32_t value = filtered >> SHIFT;
+    if (value > output + hysteresis || value < output - hysteresis) {
+      output = value;
+      return true;
+    }
+    return false;
+  }
+};
+
+#endif
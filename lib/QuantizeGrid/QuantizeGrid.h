@@ -0,0 +1,65 @@
+#ifndef __QUANTIZE_GRID_H
+#define __QUANTIZE_GRID_H
+
+#include <stdint.h>
+
+enum GridDivision {
+  GRID_NONE = 0,
+  GRID_4 = 1,       // quarter notes
+  GRID_8 = 2,       // eighth notes
+  GRID_16 = 3,      // sixteenth notes
+  GRID_32 = 4,      // thirty-second notes
+  GRID_8T = 5,      // eighth note triplets
+  GRID_16T = 6,     // sixteenth note triplets
+  GRID_32T = 7,     // thirty-second note triplets
+};
+
+#define NUM_GRID_DIVISIONS 8
+
+const int GRID_NOTES_PER_STEP[NUM_GRID_DIVISIONS] = { 0, 1, 2, 4, 8, 3, 6, 12 }; // how many grid lines fall within a single step (quarter note)
+
+/**
+ * QUANTIZE GRID
+ *
+ * Snaps a recorded position to the nearest line of the selected grid. Every supported division repeats once per
+ * step, so the grid gets pre-computed into a table of offsets indexed by the position within the step (0..TICKS_PER_STEP-1).
+ * Snapping a position on the record path is then a table lookup plus a compare to wrap around the loop end - no
+ * divide or modulo. The table only needs rebuilding when the division changes.
+*/
+template <int TICKS_PER_STEP>
+class QuantizeGrid {
+  static_assert(TICKS_PER_STEP % 24 == 0, "every grid division must land on a whole tick");
+  static_assert(TICKS_PER_STEP / 2 <= 127, "offsets must fit in an int8_t");
+public:
+  GridDivision division;
+  int8_t offsets[TICKS_PER_STEP];   // amount to add to a position to snap it to the grid, indexed by tick within the step
+
+  QuantizeGrid() {
+    setDivision(GRID_NONE);
+  }
+
+  void setDivision(GridDivision value) {
+    division = value;
+    int notes = GRID_NOTES_PER_STEP[division];
+    int interval = notes == 0 ? 1 : TICKS_PER_STEP / notes; // GRID_NONE is a grid of every tick
+    for (int tick = 0; tick < TICKS_PER_STEP; tick++) {
+      int nearest = ((tick + interval / 2) / interval) * interval;
+      offsets[tick] = nearest - tick;
+    }
+  }
+
+  /**
+   * position: the position within the loop
+   * tick: the position within the current step (ie. position % TICKS_PER_STEP)
+   * totalPPQN: the length of the loop
+  */
+  int snap(int position, int tick, int totalPPQN) {
+    int snapped = position + offsets[tick];
+    if (snapped >= totalPPQN) {
+      snapped -= totalPPQN;
+    }
+    return snapped;
+  }
+};
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef __SLEW_H
+#define __SLEW_H
+
+#include <stdint.h>
+#include <math.h>
+
+#define SLEW_Q16_ONE 65536
+
+/**
+ * SLEW
+ *
+ * Glides a 16-bit DAC code towards its target, one fixed-rate update at a time (a one pole low pass filter, so the
+ * output moves quickly at first and eases into the new note). The value is held in Q16.16 fixed point, so glides
+ * much slower than one code per update still move smoothly rather than stalling.
+ *
+ * Each update covers 'coefficient' (a Q16 fraction) of the remaining distance. The coefficient comes from the time
+ * constant: after tau the output has covered 63% of the distance, 95% after 3 * tau. Once it is within one code of the
+ * target, it snaps onto it and stops gliding.
+ *
+ * update() has no loops, and both of its paths are a handful of fixed-cost instructions, so its cost is constant
+ * however far the output has to go.
+*/
+class Slew {
+public:
+  uint32_t current;     // Q16.16 DAC code being output
+  uint32_t target;      // Q16.16 DAC code being glided to
+  int32_t coefficient;  // Q16 fraction of the remaining distance covered per update, SLEW_Q16_ONE == no glide
+
+  Slew() {
+    current = 0;
+    target = 0;
+    coefficient = SLEW_Q16_ONE;
+  }
+
+  /**
+   * tauUs of 0 turns gliding off
+  */
+  void setTimeConstant(uint32_t tauUs, uint32_t updateRateHz) {
+    if (tauUs == 0) {
+      coefficient = SLEW_Q16_ONE;
+      return;
+    }
+    coefficient = (int32_t)(SLEW_Q16_ONE * (1.0f - expf(-1000000.0f / ((float)tauUs * updateRateHz))));
+    if (coefficient < 1) {
+      coefficient = 1;
+    }
+  }
+
+  bool isEnabled() { return coefficient < SLEW_Q16_ONE; }
+  bool isGliding() { return current != target; }
+
+  void setTarget(uint16_t code) {
+    target = (uint32_t)code << 16;
+  }
+
+  // move straight to 'code', no glide
+  void jump(uint16_t code) {
+    target = (uint32_t)code << 16;
+    current = target;
+  }
+
+  uint16_t output() {
+    return (uint16_t)((current + 0x8000) >> 16);
+  }
+
+  /**
+   * one step of the glide, returns the DAC code to output
+  */
+  uint16_t update() {
+    int64_t distance = (int64_t)target - current;
+    if (distance > -SLEW_Q16_ONE && distance < SLEW_Q16_ONE) {
+      current = target;
+    } else {
+      current += (int32_t)((distance * coefficient) >> 16);
+    }
+    return output();
+  }
+};
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef __STEP_COUNTER_H
+#define __STEP_COUNTER_H
+
+#include <stdint.h>
+
+/**
+ * STEP COUNTER
+ *
+ * The Metronomes place within the loop: the tick within the current step (1..ticksPerStep), the step (1..numSteps)
+ * and the overall position, which is always (currStep - 1) * ticksPerStep + currTick.
+ *
+ * tick() is called once per clock tick, and reports whether that tick was the downbeat of a step (the first tick,
+ * played while currTick == 1). alignToDownbeat() moves the counter onto the start of the current step, so the next
+ * tick is its downbeat - used when a new clock source takes over, so its first tick is a step boundary rather than
+ * wherever the old clock had got to.
+*/
+class StepCounter {
+public:
+  uint8_t ticksPerStep;
+  uint8_t numSteps;       // used to calculate total clock loop length (in ticks)
+  uint8_t currStep;       // used to calculate an events position
+  uint8_t currTick;       // relative to ticksPerStep
+  uint16_t position;      // the clocks current position with the loop. Will be a multiplication of currTick and currStep
+
+  StepCounter(int _ticksPerStep, int _numSteps) {
+    ticksPerStep = _ticksPerStep;
+    numSteps = _numSteps;
+    currStep = 1;
+    currTick = 1;
+    position = 1;
+  }
+
+  /**
+   * returns true when this tick is the downbeat of a step
+  */
+  bool tick() {
+    bool downbeat = currTick == 1;
+    currTick += 1;
+    position += 1;
+    if (currTick > ticksPerStep) {
+      step();
+    }
+    return downbeat;
+  }
+
+  void step() {
+    currTick = 1;
+    currStep += 1;
+    if (currStep > numSteps) {  // reset step count / reset loop
+      currStep = 1;
+    }
+    position = (currStep - 1) * ticksPerStep + currTick;
+  }
+
+  /**
+   * go back to the start of the current step, so the next tick is its downbeat
+  */
+  void alignToDownbeat() {
+    setPosition(currStep, 1);
+  }
+
+  void setPosition(int step, int tick) {
+    currStep = step;
+    currTick = tick;
+    position = (currStep - 1) * ticksPerStep + currTick;
+  }
+};
+
+#endif
@@ -0,0 +1,142 @@
+#ifndef __SYNC_LINK_H
+#define __SYNC_LINK_H
+
+#include <stdint.h>
+
+#define SYNC_START_BYTE 0xA5
+#define SYNC_FRAME_LENGTH 8    // start, type, seq, hops, step, numSteps, bpm, crc
+
+enum SyncMessage {
+  SYNC_BEAT = 1,              // the master just played the downbeat of 'step'
+  SYNC_RESET = 2              // the master reset its channels (GlobalControl::handleClockReset)
+};
+
+/**
+ * A single message sent between units. Loop boundaries are not a message of their own - every beat carries the
+ * step it falls on and the loop length, so a unit joining part way through a loop finds the boundary at the next beat
+*/
+typedef struct SyncFrame {
+  uint8_t type;       // SyncMessage
+  uint8_t seq;        // incremented by the master for every frame, so followers can count lost frames
+  uint8_t hops;       // number of times the frame has been relayed, 0 when it comes straight from the master
+  uint8_t step;       // the masters current step (1..numSteps)
+  uint8_t numSteps;   // the masters loop length, in steps
+  uint8_t bpm;        // the masters tempo, for display / handing back to the pot
+} SyncFrame;
+
+/**
+ * SYNC LINK
+ *
+ * Framing for the unit to unit sync link. Frames are a fixed SYNC_FRAME_LENGTH bytes: a start byte, the six SyncFrame
+ * fields, and a CRC-8 of those fields. There is no escaping - the decoder re-synchronises by scanning for the next
+ * start byte whenever a CRC fails, which works because a misaligned frame almost never passes the CRC.
+ *
+ * Units are wired in a chain, TX to the next units RX. A unit which is receiving frames is a follower, and relays
+ * every frame on down the chain with 'hops' incremented. Relaying happens once the whole frame has arrived, so a
+ * frame reaches a follower (hops + 1) frame times after the master sent it - see frameTimeUs().
+*/
+namespace SyncLink {
+
+  inline uint8_t crc8(const uint8_t *data, int length) {
+    uint8_t crc = 0;
+    for (int i = 0; i < length; i++) {
+      crc ^= data[i];
+      for (int bit = 0; bit < 8; bit++) {
+        crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+      }
+    }
+    return crc;
+  }
+
+  /**
+   * write the frame into buffer, returning the number of bytes written (SYNC_FRAME_LENGTH)
+  */
+  inline int encode(const SyncFrame &frame, uint8_t *buffer) {
+    buffer[0] = SYNC_START_BYTE;
+    buffer[1] = frame.type;
+    buffer[2] = frame.seq;
+    buffer[3] = frame.hops;
+    buffer[4] = frame.step;
+    buffer[5] = frame.numSteps;
+    buffer[6] = frame.bpm;
+    buffer[7] = crc8(&buffer[1], SYNC_FRAME_LENGTH - 2);
+    return SYNC_FRAME_LENGTH;
+  }
+
+  /**
+   * how long (in us) a whole frame takes on the wire at 'baud' (8N1, so 10 bits a byte)
+  */
+  inline uint32_t frameTimeUs(uint32_t baud) {
+    return (SYNC_FRAME_LENGTH * 10 * 1000000UL) / baud;
+  }
+}
+
+/**
+ * SYNC DECODER
+ *
+ * Assembles frames out of a byte stream, one byte at a time, so it can be fed straight from a UART receive interrupt.
+*/
+class SyncDecoder {
+public:
+  SyncFrame frame;     // the last frame decoded
+  uint32_t frames;     // frames decoded
+  uint32_t errors;     // frames dropped on a bad CRC or unknown type
+  uint32_t lost;       // gaps in the sequence numbers of decoded frames
+
+  SyncDecoder() {
+    frames = 0;
+    errors = 0;
+    lost = 0;
+    length = 0;
+  }
+
+  /**
+   * returns true when 'byte' completes a valid frame, which is then held in 'frame'
+  */
+  bool receive(uint8_t byte) {
+    if (length == 0 && byte != SYNC_START_BYTE) {
+      return false;                               // waiting for the start of a frame
+    }
+    buffer[length++] = byte;
+    if (length < SYNC_FRAME_LENGTH) {
+      return false;
+    }
+
+    if (SyncLink::crc8(&buffer[1], SYNC_FRAME_LENGTH - 2) != buffer[7] || (buffer[1] != SYNC_BEAT && buffer[1] != SYNC_RESET)) {
+      errors += 1;
+      resync();
+      return false;
+    }
+    length = 0;
+
+    if (frames > 0 && buffer[2] != (uint8_t)(frame.seq + 1)) {
+      lost += (uint8_t)(buffer[2] - frame.seq - 1);
+    }
+    frame.type = buffer[1];
+    frame.seq = buffer[2];
+    frame.hops = buffer[3];
+    frame.step = buffer[4];
+    frame.numSteps = buffer[5];
+    frame.bpm = buffer[6];
+    frames += 1;
+    return true;
+  }
+
+private:
+  uint8_t buffer[SYNC_FRAME_LENGTH];
+  int length;
+
+  // drop the first byte of a bad frame, and pick up again from the next start byte in what was received
+  void resync() {
+    int start = 1;
+    while (start < SYNC_FRAME_LENGTH && buffer[start] != SYNC_START_BYTE) {
+      start += 1;
+    }
+    length = SYNC_FRAME_LENGTH - start;
+    for (int i = 0; i < length; i++) {
+      buffer[i] = buffer[start + i];
+    }
+  }
+};
+
+#endif
@@ -0,0 +1,163 @@
+#ifndef __TICK_TIMEBASE_H
+#define __TICK_TIMEBASE_H
+
+#include <stdint.h>
+
+/**
+ * WRAP COUNTER
+ *
+ * Extends a free running 32-bit microsecond counter (which wraps every ~71 minutes) into a 64-bit one which
+ * never wraps. extend() must be called at least once per wrap of the 32-bit counter, and never from two contexts
+ * at the same time (call it from within a critical section).
+*/
+class WrapCounter {
+public:
+  uint32_t last;      // the 32-bit count at the last call to extend()
+  uint32_t high;      // number of times the 32-bit count has wrapped
+
+  WrapCounter() {
+    last = 0;
+    high = 0;
+  }
+
+  uint64_t extend(uint32_t now) {
+    if (now < last) {
+      high += 1;
+    }
+    last = now;
+    return ((uint64_t)high << 32) | now;
+  }
+};
+
+/**
+ * TEMPO TABLE
+ *
+ * The whole microseconds and remainder of a tick, for every tempo between FIRST_BPM and FIRST_BPM + NUM_BPM - 1,
+ * worked out by the compiler for the selected resolution. Replaces a hand written table of tick lengths, which
+ * had to be re-done for every PPQN.
+*/
+template <int TICKS_PER_BEAT, int FIRST_BPM, int NUM_BPM>
+struct TempoTable {
+  uint32_t interval[NUM_BPM];   // 60000000 / (bpm * TICKS_PER_BEAT)
+  uint32_t remainder[NUM_BPM];  // 60000000 % (bpm * TICKS_PER_BEAT)
+
+  constexpr TempoTable() : interval(), remainder() {
+    for (int i = 0; i < NUM_BPM; i++) {
+      interval[i] = 60000000 / ((FIRST_BPM + i) * TICKS_PER_BEAT);
+      remainder[i] = 60000000 % ((FIRST_BPM + i) * TICKS_PER_BEAT);
+    }
+  }
+};
+
+/**
+ * TICK TIMEBASE
+ *
+ * Generates the absolute (64-bit, microsecond) due time of every clock tick for a given tempo.
+ *
+ * A tick lasts 60000000 / (bpm * ppqn) us, which is rarely a whole number (120bpm @ 96ppqn is 5208.33us). Rounding it
+ * to whole microseconds makes the clock drift against any other device, by as much as a second per hour. Instead,
+ * the whole part gets added to the next tick time, and the remainder is carried in an accumulator counting in
+ * 1 / (bpm * ppqn) us - every time a whole microsecond accumulates, it gets added on. Tick times are then never more
+ * than 1us away from the exact time, no matter how long the clock runs.
+ *
+ * TEMPO CHANGES
+ * A new tempo never moves the tick which is already due - it only changes the length of the ticks after it, so the
+ * clock keeps its phase. The accumulated remainder gets rescaled to the new denominator rather than dropped.
+ * glideTo() walks the tempo to its target 1bpm at a time, spending glideTicks ticks on each step.
+ *
+ * The resolution and tempo range are template parameters, so the tick lengths come from a TempoTable built at compile
+ * time, and changing tempo (which glides do from the clock interrupt) is a table lookup plus rescaling the carried
+ * remainder. Tempos outside of the range get clamped to it.
+*/
+template <int TICKS_PER_BEAT, int FIRST_BPM, int LAST_BPM>
+class TickTimebase {
+public:
+  static constexpr int NUM_BPM = LAST_BPM - FIRST_BPM + 1;
+  static constexpr TempoTable<TICKS_PER_BEAT, FIRST_BPM, NUM_BPM> table{};
+
+  int bpm;
+  uint32_t ticksPerMinute;  // bpm * TICKS_PER_BEAT, the denominator of the tick length
+  uint32_t interval;        // whole us per tick
+  uint32_t remainder;       // 60000000 % ticksPerMinute, carried from tick to tick
+  uint32_t remainderAcc;    // 0..ticksPerMinute-1
+  uint64_t nextTick;        // absolute time the next tick is due (us)
+  int targetBpm;            // the tempo being glided towards
+  int glideTicks;           // ticks spent on each 1bpm step of a glide
+  int glideCount;
+
+  TickTimebase(int _bpm) {
+    nextTick = 0;
+    ticksPerMinute = 0;
+    remainderAcc = 0;
+    glideTicks = 0;
+    setTempo(_bpm);
+  }
+
+  /**
+   * jump straight to a new tempo. Takes effect from the tick after nextTick
+  */
+  void setTempo(int _bpm) {
+    targetBpm = clamp(_bpm);
+    glideCount = 0;
+    applyTempo(targetBpm);
+  }
+
+  /**
+   * glide to a new tempo, or jump straight to it when glideTicks is 0
+  */
+  void glideTo(int _bpm) {
+    if (glideTicks == 0) {
+      setTempo(_bpm);
+    } else {
+      targetBpm = clamp(_bpm);
+    }
+  }
+
+  /**
+   * the first tick is due one tick after 'now'
+  */
+  void start(uint64_t now) {
+    nextTick = now;
+    remainderAcc = 0;
+    advance();
+  }
+
+  /**
+   * call once the tick at nextTick has been emitted, to move on to the one after it
+  */
+  void advance() {
+    nextTick += interval;
+    remainderAcc += remainder;
+    if (remainderAcc >= ticksPerMinute) {
+      remainderAcc -= ticksPerMinute;
+      nextTick += 1;
+    }
+
+    if (bpm != targetBpm && ++glideCount >= glideTicks) {
+      glideCount = 0;
+      applyTempo(bpm < targetBpm ? bpm + 1 : bpm - 1);
+    }
+  }
+
+private:
+
+  static int clamp(int _bpm) {
+    return _bpm < FIRST_BPM ? FIRST_BPM : (_bpm > LAST_BPM ? LAST_BPM : _bpm);
+  }
+
+  void applyTempo(int _bpm) {
+    uint32_t newTicksPerMinute = _bpm * TICKS_PER_BEAT;
+    if (ticksPerMinute) {
+      remainderAcc = (remainderAcc * _bpm) / bpm; // keep the fraction of a us already accumulated
+    }
+    bpm = _bpm;
+    ticksPerMinute = newTicksPerMinute;
+    interval = table.interval[bpm - FIRST_BPM];
+    remainder = table.remainder[bpm - FIRST_BPM];
+  }
+};
+
+template <int TICKS_PER_BEAT, int FIRST_BPM, int LAST_BPM>
+constexpr TempoTable<TICKS_PER_BEAT, FIRST_BPM, TickTimebase<TICKS_PER_BEAT, FIRST_BPM, LAST_BPM>::NUM_BPM> TickTimebase<TICKS_PER_BEAT, FIRST_BPM, LAST_BPM>::table;
+
+#endif
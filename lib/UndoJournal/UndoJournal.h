@@ -0,0 +1,136 @@
+#ifndef __UNDO_JOURNAL_H
+#define __UNDO_JOURNAL_H
+
+#include <stdint.h>
+#include "EventStore.h"
+
+/**
+ * UNDO JOURNAL
+ *
+ * A fixed size ring of the sequence edits made during each recording pass. Before an event gets created, overwritten
+ * or removed, the value it had (or the fact it did not exist) is recorded along with its position. Undoing a pass
+ * walks back through that pass's entries only, so it costs time proportional to the size of the edit rather than the
+ * length of the loop.
+ *
+ * When the ring fills up the oldest pass gets dropped as a whole. A single pass which does not fit in the ring can
+ * not be undone.
+*/
+template <int CAPACITY>
+class UndoJournal {
+public:
+
+  typedef struct Entry {
+    uint16_t position;     // position of the edited event
+    uint8_t activeNotes;   // the events value before the edit
+    uint8_t noteIndex;
+    bool gate;
+    uint8_t offset;
+    bool existed;          // false if there was no event at position before the edit
+    bool passStart;        // true for the first entry of each pass
+  } Entry;
+
+  Entry entries[CAPACITY];
+  int head;                // index the next entry gets written to
+  int count;               // number of entries in the journal
+  bool newPass;            // the next entry recorded starts a new pass
+  bool overflowed;         // the current pass outgrew the journal, so nothing more gets recorded until the next pass
+
+  UndoJournal() {
+    clear();
+  }
+
+  void clear() {
+    head = 0;
+    count = 0;
+    newPass = true;
+    overflowed = false;
+  }
+
+  int size() { return count; }
+
+  /**
+   * mark the end of the current pass. Cheap enough to call every time the loop wraps - passes without edits do not
+   * take up any room in the journal
+  */
+  void beginPass() {
+    newPass = true;
+  }
+
+  /**
+   * record the state of an event before it gets modified. node should be NULL if no event exists at position yet
+  */
+  void record(int position, SequenceNode *node) {
+    bool passStart = newPass;
+    if (newPass) {
+      newPass = false;
+      overflowed = false;
+    } else if (overflowed) {
+      return;
+    }
+
+    if (count == CAPACITY) {
+      dropOldestPass();
+      if (count == 0 && !passStart) { // the current pass was the oldest pass
+        overflowed = true;
+        return;
+      }
+    }
+
+    Entry *entry = &entries[head];
+    entry->position = position;
+    entry->existed = node != NULL;
+    entry->passStart = passStart;
+    if (node) {
+      entry->activeNotes = node->activeNotes;
+      entry->noteIndex = node->noteIndex;
+      entry->gate = node->gate;
+      entry->offset = node->offset;
+    }
+    head = head + 1 == CAPACITY ? 0 : head + 1;
+    count += 1;
+  }
+
+  /**
+   * restore every event modified during the most recent pass. returns false if there was nothing to undo
+  */
+  template <typename Store>
+  bool undoLastPass(Store &store) {
+    if (overflowed || count == 0) {
+      return false;
+    }
+    while (count > 0) {
+      head = head == 0 ? CAPACITY - 1 : head - 1;
+      count -= 1;
+      Entry *entry = &entries[head];
+      if (entry->existed) {
+        SequenceNode *node = store.insert(entry->position);
+        if (node) {
+          node->activeNotes = entry->activeNotes;
+          node->noteIndex = entry->noteIndex;
+          node->gate = entry->gate;
+          node->offset = entry->offset;
+        }
+      } else {
+        store.remove(entry->position);
+      }
+      if (entry->passStart) {
+        break;
+      }
+    }
+    newPass = true;
+    return true;
+  }
+
+private:
+
+  void dropOldestPass() {
+    int tail = head - count;
+    if (tail < 0) tail += CAPACITY;
+    do {
+      tail = tail + 1 == CAPACITY ? 0 : tail + 1;
+      count -= 1;
+    } while (count > 0 && !entries[tail].passStart);
+  }
+};
+
+#endif
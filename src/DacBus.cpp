@@ -0,0 +1,151 @@
+#include "DacBus.h"
+
+DacBus *DacBus::instance = NULL;
+
+#define DMA_STREAM4_FLAGS (DMA_HIFCR_CTCIF4 | DMA_HIFCR_CHTIF4 | DMA_HIFCR_CTEIF4 | DMA_HIFCR_CDMEIF4 | DMA_HIFCR_CFEIF4)
+
+void DacBus::init() {
+  instance = this;
+
+  spi.format(8, 1);                   // DAC8554 clocks data in on the falling edge
+  spi.frequency(DAC_SPI_FREQUENCY);
+  spi.write(0x00);                    // let mbed set up the pins and SPI2 (no chip is selected, so nothing listens)
+  spiConfig = SPI2->CR1;
+
+  RCC->AHB1ENR |= RCC_AHB1ENR_DMA1EN;
+  DMA1_Stream4->CR = 0;
+  while (DMA1_Stream4->CR & DMA_SxCR_EN) {}
+  DMA1_Stream4->PAR = (uint32_t)&SPI2->DR;
+  DMA1_Stream4->FCR = 0;              // direct mode, one byte at a time
+  DMA1->HIFCR = DMA_STREAM4_FLAGS;
+
+  NVIC_SetVector(DMA1_Stream4_IRQn, (uint32_t)&DacBus::irqHandler);
+  NVIC_SetPriority(DMA1_Stream4_IRQn, DAC_DMA_IRQ_PRIORITY);
+  NVIC_EnableIRQ(DMA1_Stream4_IRQn);
+
+  resetStats();
+}
+
+/**
+ * write an output into the frame. The slew engine writes the frame from its interrupt, so everything else goes
+ * through here rather than touching 'frame' directly
+*/
+bool DacBus::write(int chip, int chan, uint16_t value) {
+  core_util_critical_section_enter();
+  bool changed = frame.write(chip, chan, value);
+  core_util_critical_section_exit();
+  return changed;
+}
+
+void DacBus::invalidate(int chip, int chan) {
+  core_util_critical_section_enter();
+  frame.invalidate(chip, chan);
+  core_util_critical_section_exit();
+}
+
+/**
+ * queue everything written to the frame since the last flush
+*/
+void DacBus::flush() {
+  DacCommand commands[DAC_FRAME_MAX_COMMANDS];
+  core_util_critical_section_enter();
+  if (!frame.isDirty()) {
+    core_util_critical_section_exit();
+    return;
+  }
+  int count = frame.flush(commands);
+  for (int i = 0; i < count; i++) {
+    enqueue(commands[i].chips, commands[i].word);
+  }
+  core_util_critical_section_exit();
+}
+
+/**
+ * queue a single 24-bit write to the selected chip(s). Returns false (and drops the write) if the queue is full
+*/
+bool DacBus::enqueue(uint8_t chips, uint32_t word) {
+  core_util_critical_section_enter();
+  if ((uint16_t)(head - tail) >= DAC_QUEUE_SIZE) {
+    stats.dropped += 1;
+    core_util_critical_section_exit();
+    return false;
+  }
+  DacCommand *command = &queue[head & (DAC_QUEUE_SIZE - 1)];
+  command->chips = chips;
+  command->word = word;
+  head += 1;
+  if ((uint16_t)(head - tail) > stats.maxQueueDepth) {
+    stats.maxQueueDepth = (uint16_t)(head - tail);
+  }
+
+  if (!active) {
+    active = true;
+    busyStart = DWT->CYCCNT;
+    otherConfig = SPI2->CR1;
+    if (otherConfig != spiConfig) {   // a DAC8554 driver used the bus since the last run
+      SPI2->CR1 = spiConfig & ~SPI_CR1_SPE;
+      SPI2->CR1 = spiConfig;
+    }
+    startNext();
+  }
+  core_util_critical_section_exit();
+  return true;
+}
+
+void DacBus::resetStats() {
+  memset(&stats, 0, sizeof(Stats));
+}
+
+// send the write at the tail of the queue, or finish the run if there are none left
+void DacBus::startNext() {
+  if (tail == head) {
+    if (otherConfig != spiConfig) {
+      SPI2->CR1 = otherConfig & ~SPI_CR1_SPE;
+      SPI2->CR1 = otherConfig;
+    }
+    stats.lastBusyCycles = DWT->CYCCNT - busyStart;
+    stats.busyCycles += stats.lastBusyCycles;
+    active = false;
+    return;
+  }
+
+  DacCommand *command = &queue[tail & (DAC_QUEUE_SIZE - 1)];
+  txBytes[0] = (command->word >> 16) & 0xFF;
+  txBytes[1] = (command->word >> 8) & 0xFF;
+  txBytes[2] = command->word & 0xFF;
+  activeChips = command->chips;
+
+  select(activeChips, 0);
+  DMA1->HIFCR = DMA_STREAM4_FLAGS;
+  DMA1_Stream4->M0AR = (uint32_t)txBytes;
+  DMA1_Stream4->NDTR = 3;
+  DMA1_Stream4->CR = DMA_SxCR_DIR_0 | DMA_SxCR_MINC | DMA_SxCR_TCIE | DMA_SxCR_TEIE | DMA_SxCR_EN; // channel 0, memory -> SPI2, bytes
+  SPI2->CR2 |= SPI_CR2_TXDMAEN;
+}
+
+void DacBus::irqHandler() {
+  instance->handleTransferComplete();
+}
+
+/**
+ * the DMA has handed the last byte to SPI2, but it still has to be shifted out before the chip select can go high.
+ * That is under half a microsecond at DAC_SPI_FREQUENCY, so it gets waited out here
+*/
+void DacBus::handleTransferComplete() {
+  DMA1->HIFCR = DMA_STREAM4_FLAGS;
+  while (!(SPI2->SR & SPI_SR_TXE)) {}
+  while (SPI2->SR & SPI_SR_BSY) {}
+  select(activeChips, 1);
+  SPI2->CR2 &= ~SPI_CR2_TXDMAEN;
+  (void)SPI2->DR;                     // nothing gets read back, clear the receive overrun
+  (void)SPI2->SR;
+
+  tail += 1;
+  stats.transactions += 1;
+  startNext();
+}
+
+void DacBus::select(uint8_t chips, int state) {
+  if (chips & (1 << DAC_PITCH)) cs1.write(state);
+  if (chips & (1 << DAC_BEND)) cs2.write(state);
+}
@@ -0,0 +1,82 @@
+#ifndef __DAC_BUS_H
+#define __DAC_BUS_H
+
+#include "main.h"
+#include "DacFrame.h"
+
+/**
+ * DAC BUS
+ *
+ * Sends a DacFrame to the two DAC8554s on SPI2 - dac1 (1v/o, DAC_PITCH) and dac2 (pitch bend, DAC_BEND). Channels
+ * write their outputs into 'frame' (via write()) as they go, and main() calls flush() once per pass of the main loop,
+ * after every channel has been polled, so all eight outputs change together rather than staggered across the pass.
+ *
+ * While a 1v/o output is gliding, SlewEngine also writes and flushes the frame from its interrupt, at
+ * SLEW_UPDATE_RATE. write(), invalidate() and flush() are critical sections so the two never interleave - outputs
+ * written by the main loop just go out at whichever flush comes first.
+ *
+ * TRANSACTION QUEUE
+ * flush() (and enqueue()) only queue the writes and return - nothing waits on the SPI. Each queued write is sent by
+ * DMA1 Stream 4 (channel 0, SPI2_TX): the chip select(s) go low, the DMA feeds the three bytes to SPI2, and the
+ * transfer complete interrupt waits out the last byte, raises the chip select(s) and starts the next write. Writes
+ * go out in the order they were queued, so a frames stores always land before the load which follows them.
+ *
+ * The DAC8554 drivers still own the chips for init() and calibration, using mbed's blocking SPI on the same
+ * peripheral. They must not be used while isBusy(). The SPI2 configuration they leave behind is put back once the
+ * queue runs dry.
+ *
+ * STATS
+ * Queue depth and how long the bus has spent sending (in CPU cycles, from the DWT cycle counter) are kept in
+ * 'stats'. Read them with a debugger.
+*/
+class DacBus {
+public:
+
+  typedef struct Stats {
+    uint32_t transactions;      // writes sent
+    uint32_t dropped;           // writes which did not fit in the queue
+    uint32_t maxQueueDepth;     // most writes waiting (or being sent) at once
+    uint32_t busyCycles;        // total time the bus has spent sending
+    uint32_t lastBusyCycles;    // how long the most recent run of writes took, from queueing the first to the last finishing
+  } Stats;
+
+  SPI spi;
+  DigitalOut cs1;
+  DigitalOut cs2;
+  DacFrame frame;
+  Stats stats;
+
+  DacBus(PinName mosi, PinName sck, PinName cs1Pin, PinName cs2Pin) : spi(mosi, NC, sck), cs1(cs1Pin, 1), cs2(cs2Pin, 1) {
+    head = 0;
+    tail = 0;
+    active = false;
+  };
+
+  void init();
+  bool write(int chip, int chan, uint16_t value);
+  void invalidate(int chip, int chan);
+  void flush();
+  bool enqueue(uint8_t chips, uint32_t word);
+  int queueDepth() { return (uint16_t)(head - tail); }
+  bool isBusy() { return active; }
+  void resetStats();
+
+private:
+  static DacBus *instance;
+  DacCommand queue[DAC_QUEUE_SIZE];   // ring buffer, DAC_QUEUE_SIZE must be a power of 2
+  volatile uint16_t head;
+  volatile uint16_t tail;
+  volatile bool active;               // a write is being sent
+  uint8_t txBytes[3];                 // the write being sent, read by the DMA
+  uint8_t activeChips;
+  uint32_t spiConfig;                 // SPI2 CR1 for the DACs, captured at init()
+  uint32_t otherConfig;               // SPI2 CR1 as it was before the current run of writes
+  uint32_t busyStart;
+
+  static void irqHandler();
+  void handleTransferComplete();
+  void startNext();
+  void select(uint8_t chips, int state);
+};
+
+#endif
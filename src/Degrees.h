@@ -3,12 +3,15 @@
 
 #include "main.h"
 #include "MCP23017.h"
+#include "ExtiDispatcher.h"
 
 class Degrees {
   public:
 
     MCP23017 * io;
+    ExtiDispatcher *exti;
     DigitalIn ioInterupt;
+    PinName ioIntPin;
     bool interuptDetected;
     bool hasChanged[4];
     uint16_t currState;
@@ -16,14 +19,17 @@ class Degrees {
 
     int switchStates[8];
 
-    Degrees(PinName ioIntPin, MCP23017 *io_ptr) : ioInterupt(ioIntPin, PullUp) {
+    Degrees(PinName _ioIntPin, ExtiDispatcher *exti_ptr, MCP23017 *io_ptr) : ioInterupt(_ioIntPin, PullUp) {
+      ioIntPin = _ioIntPin;
+      exti = exti_ptr;
       io = io_ptr;
       interuptDetected = false;
-      // ioInterupt.fall(callback(this, &Degrees::handleInterupt));
     };
 
     void init() {
 
+      exti->attach(ioIntPin, ExtiDispatcher::FALLING, callback(this, &Degrees::handleInterupt), UI_IRQ_PRIORITY);
+
       io->init();
       io->setDirection(MCP23017_PORTA, 0xFF);           // set PORTA pins as inputs
       io->setDirection(MCP23017_PORTB, 0xFF);           // set PORTB pins as inputs
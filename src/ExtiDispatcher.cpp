@@ -0,0 +1,136 @@
+#include "ExtiDispatcher.h"
+
+ExtiDispatcher *ExtiDispatcher::instance = NULL;
+
+void ExtiDispatcher::init() {
+  instance = this;
+
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;    // enable the DWT cycle counter, used for stats
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+  RCC->APB2ENR |= RCC_APB2ENR_SYSCFGEN;              // SYSCFG holds the EXTI line -> GPIO port mapping
+  memset(&stats, 0, sizeof(Stats));
+}
+
+/**
+ * call func on the given edge(s) of 'pin'. Replaces whatever was attached to the same line (pin number) before
+*/
+void ExtiDispatcher::attach(PinName pin, Edge edge, Callback<void()> func, uint32_t priority) {
+  int line = STM_PIN(pin);
+  uint32_t bit = 1 << line;
+  int shift = (line & 3) * 4;
+
+  core_util_critical_section_enter();
+  EXTI->IMR &= ~bit;
+  handlers[line] = func;
+  SYSCFG->EXTICR[line >> 2] = (SYSCFG->EXTICR[line >> 2] & ~(0xF << shift)) | (STM_PORT(pin) << shift);
+  if (edge & RISING) {
+    EXTI->RTSR |= bit;
+  } else {
+    EXTI->RTSR &= ~bit;
+  }
+  if (edge & FALLING) {
+    EXTI->FTSR |= bit;
+  } else {
+    EXTI->FTSR &= ~bit;
+  }
+  EXTI->PR = bit;                                     // drop anything flagged while the line was being set up
+  EXTI->IMR |= bit;
+  core_util_critical_section_exit();
+
+  IRQn_Type irq = lineIRQ(line);
+  NVIC_SetVector(irq, lineVector(line));
+  NVIC_SetPriority(irq, priority);
+  NVIC_EnableIRQ(irq);
+}
+
+/**
+ * stop listening to 'pin'. The NVIC vector is left enabled, as it may be shared with other lines
+*/
+void ExtiDispatcher::detach(PinName pin) {
+  uint32_t bit = 1 << STM_PIN(pin);
+  core_util_critical_section_enter();
+  EXTI->IMR &= ~bit;
+  EXTI->RTSR &= ~bit;
+  EXTI->FTSR &= ~bit;
+  EXTI->PR = bit;
+  core_util_critical_section_exit();
+}
+
+/**
+ * compare the latency of an edge on 'pin' through mbed's InterruptIn and through the dispatcher, at the given NVIC
+ * priority. Must be called before 'pin' gets attached, as it takes the line over while measuring
+*/
+void ExtiDispatcher::measureLatency(PinName pin, uint32_t priority) {
+  int line = STM_PIN(pin);
+
+  {
+    InterruptIn probe(pin);
+    probe.rise(callback(this, &ExtiDispatcher::latencyProbe));
+    probe.fall(callback(this, &ExtiDispatcher::latencyProbe));
+    NVIC_SetPriority(lineIRQ(line), priority);
+    stats.interruptInLatencyCycles = timeSoftwareEdges(line);
+  }
+
+  attach(pin, BOTH, callback(this, &ExtiDispatcher::latencyProbe), priority);
+  stats.dispatchLatencyCycles = timeSoftwareEdges(line);
+  detach(pin);
+}
+
+void ExtiDispatcher::latencyProbe() {
+  probeTime = DWT->CYCCNT;
+  probed = true;
+}
+
+/**
+ * software trigger 'line' EXTI_LATENCY_SAMPLES times, returning the fewest cycles it took to reach latencyProbe()
+ * (or 0 if it never got there)
+*/
+uint32_t ExtiDispatcher::timeSoftwareEdges(int line) {
+  uint32_t best = 0;
+  for (int i = 0; i < EXTI_LATENCY_SAMPLES; i++) {
+    probed = false;
+    uint32_t start = DWT->CYCCNT;
+    EXTI->SWIER = 1 << line;
+    while (!probed && DWT->CYCCNT - start < SystemCoreClock / 1000) {}  // give up after 1ms
+    uint32_t cycles = probeTime - start;
+    if (probed && (best == 0 || cycles < best)) {
+      best = cycles;
+    }
+  }
+  return best;
+}
+
+IRQn_Type ExtiDispatcher::lineIRQ(int line) {
+  if (line <= 4) {
+    return (IRQn_Type)(EXTI0_IRQn + line);            // EXTI0_IRQn..EXTI4_IRQn are consecutive
+  }
+  return line <= 9 ? EXTI9_5_IRQn : EXTI15_10_IRQn;
+}
+
+uint32_t ExtiDispatcher::lineVector(int line) {
+  switch (line) {
+    case 0: return (uint32_t)&ExtiDispatcher::irqHandler<0, 0>;
+    case 1: return (uint32_t)&ExtiDispatcher::irqHandler<1, 1>;
+    case 2: return (uint32_t)&ExtiDispatcher::irqHandler<2, 2>;
+    case 3: return (uint32_t)&ExtiDispatcher::irqHandler<3, 3>;
+    case 4: return (uint32_t)&ExtiDispatcher::irqHandler<4, 4>;
+  }
+  return line <= 9 ? (uint32_t)&ExtiDispatcher::irqHandler<5, 9> : (uint32_t)&ExtiDispatcher::irqHandler<10, 15>;
+}
+
+/**
+ * one of these per EXTI vector. Clears every pending line belonging to the vector, then calls their callbacks
+ * (lowest line first)
+*/
+template <int FIRST_LINE, int LAST_LINE>
+void ExtiDispatcher::irqHandler() {
+  const uint32_t mask = (0xFFFFu >> (15 - LAST_LINE)) & (0xFFFFu << FIRST_LINE);
+  uint32_t pending = EXTI->PR & EXTI->IMR & mask;
+  EXTI->PR = pending;                                 // PR bits are cleared by writing 1
+  while (pending) {
+    int line = __builtin_ctz(pending);
+    pending &= pending - 1;
+    instance->handlers[line].call();
+  }
+}
@@ -0,0 +1,77 @@
+#ifndef __EXTI_DISPATCHER_H
+#define __EXTI_DISPATCHER_H
+
+#include "main.h"
+
+/**
+ * EXTI DISPATCHER
+ *
+ * Routes the STM32 external interrupt lines straight to their callbacks. mbed's InterruptIn goes through a generic
+ * gpio_irq layer which, on every edge, searches its channel tables, reads the pin back to work out which edge
+ * happened, and then calls InterruptIn's own handler before finally reaching the attached callback. Here each EXTI
+ * vector is pointed at a handler which clears the pending bits and calls the callback out of a static table
+ * indexed by line number - nothing else.
+ *
+ * LINES
+ * There are 16 EXTI lines, one per pin number (PA3, PB3, PC3 all share line 3), so only one pin per number can be
+ * attached at a time. Lines 0-4 each have their own vector, lines 5-9 and 10-15 share one vector each. Lines which
+ * share a vector share its NVIC priority, the last one attached sets it.
+ *
+ *   line   pin                   callback                              priority
+ *   0      TOUCH_INT_B           TouchChannel::touchInteruptFn         UI_IRQ_PRIORITY
+ *   1      TOUCH_INT_A           TouchChannel::touchInteruptFn         UI_IRQ_PRIORITY
+ *   3      EXT_CLOCK_INPUT       Metronome::handleExternalClock        EXT_CLOCK_IRQ_PRIORITY
+ *   4      DEGREES_INT           Degrees::handleInterupt               UI_IRQ_PRIORITY
+ *   5, 6   TOUCH_INT_OCT_CD, AB  GlobalControl::handleOctaveInterupt   UI_IRQ_PRIORITY
+ *   7, 13  TOUCH_INT_CTRL_2, 1   GlobalControl::handleTouchInterupt    UI_IRQ_PRIORITY
+ *   9-12   IO_INT_PIN_D..A       TouchChannel::ioInteruptFn            UI_IRQ_PRIORITY
+ *   14, 15 TOUCH_INT_D, C        TouchChannel::touchInteruptFn         UI_IRQ_PRIORITY
+ *
+ * The pin mode (pull up etc.) is left to a DigitalIn on the same pin, this only deals with the EXTI and NVIC side.
+ *
+ * STATS
+ * measureLatency() times how long it takes from an edge being flagged to its callback starting (in CPU cycles),
+ * once through mbed's InterruptIn and once through the dispatcher, so the two can be compared. The edges are
+ * software triggered (EXTI SWIER), and the best of EXTI_LATENCY_SAMPLES is kept, so interrupts which happen to
+ * land during the measurement do not skew it. Read them with a debugger.
+*/
+class ExtiDispatcher {
+public:
+
+  enum Edge {
+    RISING = 1,
+    FALLING = 2,
+    BOTH = 3
+  };
+
+  typedef struct Stats {
+    uint32_t interruptInLatencyCycles; // edge flagged -> callback, via mbed InterruptIn
+    uint32_t dispatchLatencyCycles;    // edge flagged -> callback, via the dispatcher
+  } Stats;
+
+  Callback<void()> handlers[NUM_EXTI_LINES];
+  Stats stats;
+
+  ExtiDispatcher() {
+    probed = false;
+  };
+
+  void init();
+  void attach(PinName pin, Edge edge, Callback<void()> func, uint32_t priority);
+  void detach(PinName pin);
+  void measureLatency(PinName pin, uint32_t priority);
+
+private:
+  static ExtiDispatcher *instance;
+  template <int FIRST_LINE, int LAST_LINE> static void irqHandler();
+
+  volatile bool probed;
+  volatile uint32_t probeTime;
+  void latencyProbe();
+  uint32_t timeSoftwareEdges(int line);
+
+  static IRQn_Type lineIRQ(int line);
+  static uint32_t lineVector(int line);
+};
+
+#endif
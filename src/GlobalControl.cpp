@@ -3,9 +3,15 @@
 void GlobalControl::init() {
 
   metronome->init();
+  calibrator.scheduler = metronome->scheduler;
 
   metronome->attachTickCallback(callback(this, &GlobalControl::tickChannels));
 
+  exti->attach(interuptPins[0], ExtiDispatcher::FALLING, callback(this, &GlobalControl::handleTouchInterupt), UI_IRQ_PRIORITY);
+  exti->attach(interuptPins[1], ExtiDispatcher::FALLING, callback(this, &GlobalControl::handleTouchInterupt), UI_IRQ_PRIORITY);
+  exti->attach(interuptPins[2], ExtiDispatcher::FALLING, callback(this, &GlobalControl::handleOctaveInterupt), UI_IRQ_PRIORITY);
+  exti->attach(interuptPins[3], ExtiDispatcher::FALLING, callback(this, &GlobalControl::handleOctaveInterupt), UI_IRQ_PRIORITY);
+
   touchCtrl1->init();
   touchCtrl2->init();
   touchOctAB->init();
@@ -33,6 +39,10 @@ void GlobalControl::poll() {
     octaveTouchDetected = false;
   }
 
+  if (sync->poll()) {
+    handleClockReset();             // the master unit reset its channels
+  }
+
   if (timer.read() > 2) {
     calibrateChannel(selectedChannel);
     timer.stop();
@@ -93,6 +103,9 @@ void GlobalControl::handleOctaveTouched() {
           case 0b00000001: // loop length is currenttly being touched
             setChannelLoopMultiplier(i);
             break;
+          case 0b1000000000: // reset is currently being touched
+            setChannelClockRate(i);
+            break;
           case 0b00000000:
             setChannelOctave(i);
             break;
@@ -128,6 +141,30 @@ void GlobalControl::setChannelLoopMultiplier(int pad) {
   }
 }
 
+/**
+ * each channels four octave pads select a clock rate of 1/4x, 1/2x, 2x and 4x. Touching the pad of the current rate again goes back to 1x
+*/
+void GlobalControl::setChannelClockRate(int pad) {
+  switch (pad) {
+    case 0:  channels[2]->setClockRate(1, 4); break;
+    case 1:  channels[2]->setClockRate(1, 2); break;
+    case 2:  channels[2]->setClockRate(2, 1); break;
+    case 3:  channels[2]->setClockRate(4, 1); break;
+    case 4:  channels[3]->setClockRate(1, 4); break;
+    case 5:  channels[3]->setClockRate(1, 2); break;
+    case 6:  channels[3]->setClockRate(2, 1); break;
+    case 7:  channels[3]->setClockRate(4, 1); break;
+    case 8:  channels[0]->setClockRate(1, 4); break;
+    case 9:  channels[0]->setClockRate(1, 2); break;
+    case 10: channels[0]->setClockRate(2, 1); break;
+    case 11: channels[0]->setClockRate(4, 1); break;
+    case 12: channels[1]->setClockRate(1, 4); break;
+    case 13: channels[1]->setClockRate(1, 2); break;
+    case 14: channels[1]->setClockRate(2, 1); break;
+    case 15: channels[1]->setClockRate(4, 1); break;
+  }
+}
+
 void GlobalControl::setChannelOctave(int pad) {
   switch (pad) {
     case 0:  channels[2]->setOctave(0); break;
@@ -299,6 +336,57 @@ bool GlobalControl::handleGesture() {
     case CLEAR_CH_D_PB:
       channels[3]->clearPitchBendSequence();
       return true;
+    case QUANT_GRID_CH_A:
+      channels[0]->cycleTimeQuantization();
+      return true;
+    case QUANT_GRID_CH_B:
+      channels[1]->cycleTimeQuantization();
+      return true;
+    case QUANT_GRID_CH_C:
+      channels[2]->cycleTimeQuantization();
+      return true;
+    case QUANT_GRID_CH_D:
+      channels[3]->cycleTimeQuantization();
+      return true;
+    case PASTE_CH_A:
+      channels[0]->pasteSequence(channels[selectedChannel]);
+      return true;
+    case PASTE_CH_B:
+      channels[1]->pasteSequence(channels[selectedChannel]);
+      return true;
+    case PASTE_CH_C:
+      channels[2]->pasteSequence(channels[selectedChannel]);
+      return true;
+    case PASTE_CH_D:
+      channels[3]->pasteSequence(channels[selectedChannel]);
+      return true;
+    case GATE_MODE_CH_A:
+      channels[0]->toggleGateMode();
+      return true;
+    case GATE_MODE_CH_B:
+      channels[1]->toggleGateMode();
+      return true;
+    case GATE_MODE_CH_C:
+      channels[2]->toggleGateMode();
+      return true;
+    case GATE_MODE_CH_D:
+      channels[3]->toggleGateMode();
+      return true;
+    case SLEW_CH_A:
+      channels[0]->cycleSlewTime();
+      return true;
+    case SLEW_CH_B:
+      channels[1]->cycleSlewTime();
+      return true;
+    case SLEW_CH_C:
+      channels[2]->cycleSlewTime();
+      return true;
+    case SLEW_CH_D:
+      channels[3]->cycleSlewTime();
+      return true;
+    case UNDO_PASS:
+      channels[selectedChannel]->undoLastPass();
+      return true;
     case CLEAR_SEQ_ALL:
       channels[0]->clearLoop();
       channels[1]->clearLoop();
@@ -327,6 +415,7 @@ void GlobalControl::handleFreeze(bool enable) {
  * HANDLE RESET
 */
 void GlobalControl::handleClockReset() {
+  sync->sendReset();              // followers reset along with us
   // reset all channels
   channels[0]->reset();
   channels[1]->reset();
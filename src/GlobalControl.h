@@ -8,6 +8,8 @@
 #include "VCOCalibrator.h"
 #include "DualDigitDisplay.h"
 #include "Metronome.h"
+#include "ExtiDispatcher.h"
+#include "SyncPort.h"
 
 
 class GlobalControl {
@@ -18,6 +20,8 @@ public:
   };
 
   Metronome *metronome;
+  ExtiDispatcher *exti;
+  SyncPort *sync;                    // keeps the clock and resets in step with other units
   VCOCalibrator calibrator;
   CAP1208 *touchCtrl1;
   CAP1208 *touchCtrl2;
@@ -26,10 +30,11 @@ public:
   TouchChannel *channels[4];
   Timer timer;
   DigitalOut rec_led;
-  InterruptIn ctrl1Interupt;
-  InterruptIn ctrl2Interupt;
-  InterruptIn octaveInteruptAB;
-  InterruptIn octaveInteruptCD;
+  DigitalIn ctrl1Interupt;
+  DigitalIn ctrl2Interupt;
+  DigitalIn octaveInteruptAB;
+  DigitalIn octaveInteruptCD;
+  PinName interuptPins[4];           // ctrl1, ctrl2, octave AB, octave CD
   uint32_t flashAddr = 0x08060000;   // should be 'sector 7', program memory address starts @ 0x08000000
 
   Mode mode;
@@ -45,6 +50,8 @@ public:
 
   GlobalControl(
       Metronome *metronome_ptr,
+      ExtiDispatcher *exti_ptr,
+      SyncPort *sync_ptr,
       CAP1208 * ctrl1_ptr,
       CAP1208 *ctrl2_ptr,
       CAP1208 *tchAB_ptr,
@@ -61,6 +68,8 @@ public:
   {
     mode = Mode::DEFAULT;
     metronome = metronome_ptr;
+    exti = exti_ptr;
+    sync = sync_ptr;
     touchCtrl1 = ctrl1_ptr;
     touchCtrl2 = ctrl2_ptr;
     touchOctAB = tchAB_ptr;
@@ -70,10 +79,10 @@ public:
     channels[2] = chanC_ptr;
     channels[3] = chanD_ptr;
     rec_led.write(0);
-    ctrl1Interupt.fall(callback(this, &GlobalControl::handleTouchInterupt));
-    ctrl2Interupt.fall(callback(this, &GlobalControl::handleTouchInterupt));
-    octaveInteruptAB.fall(callback(this, &GlobalControl::handleOctaveInterupt));
-    octaveInteruptCD.fall(callback(this, &GlobalControl::handleOctaveInterupt));
+    interuptPins[0] = ctrl1_int;
+    interuptPins[1] = ctrl2_int;
+    interuptPins[2] = oct_int_ab;
+    interuptPins[3] = oct_int_cd;
   }
 
   void init();
@@ -97,6 +106,7 @@ public:
   void handleOctaveTouched();
   void setChannelOctave(int pad);
   void setChannelLoopMultiplier(int pad);
+  void setChannelClockRate(int pad);
 
   void tickChannels();
 
@@ -140,7 +150,24 @@ private:
     CLEAR_CH_B_PB     = 0b0010000010000000,
     CLEAR_CH_C_PB     = 0b0100000010000000,
     CLEAR_CH_D_PB     = 0b1000000010000000,
+    QUANT_GRID_CH_A   = 0b0001000000000001, // LOOP_LENGTH + CHANNEL (cycles the record quantization grid)
+    QUANT_GRID_CH_B   = 0b0010000000000001,
+    QUANT_GRID_CH_C   = 0b0100000000000001,
+    QUANT_GRID_CH_D   = 0b1000000000000001,
+    PASTE_CH_A        = 0b0001100000000000, // CTRL_ALL + CHANNEL (pastes the selected channels sequence into CHANNEL)
+    PASTE_CH_B        = 0b0010100000000000,
+    PASTE_CH_C        = 0b0100100000000000,
+    PASTE_CH_D        = 0b1000100000000000,
+    GATE_MODE_CH_A    = 0b0001000000000010, // PB_RANGE + CHANNEL (toggles between gate and trigger output)
+    GATE_MODE_CH_B    = 0b0010000000000010,
+    GATE_MODE_CH_C    = 0b0100000000000010,
+    GATE_MODE_CH_D    = 0b1000000000000010,
+    SLEW_CH_A         = 0b0001001000000000, // RESET + CHANNEL (cycles the 1v/o glide time)
+    SLEW_CH_B         = 0b0010001000000000,
+    SLEW_CH_C         = 0b0100001000000000,
+    SLEW_CH_D         = 0b1000001000000000,
     CLEAR_SEQ_ALL     = 0b0000100001000000,
+    UNDO_PASS         = 0b0000000001100000, // CLEAR_SEQ + RECORD (undo the selected channels last recording pass)
     RESET_CALIBRATION = 0b0000100000001000  // CTRL_ALL + CALIBRATE
   };
 };
@@ -3,69 +3,170 @@
 // clock initialization
 void Metronome::init() {
   tempoOutput.write(0);
-  this->updateTempo(tickInterval);
-  this->pollTempoPot();
+  tempoPotFilter.update(tempoPot.read_u16());
+  bpm = tempoPotBpm();
+  timebase.setTempo(bpm);           // start at the pots tempo, no glide
+  this->startInternalClock();
 }
 
 void Metronome::poll() {
   this->pollTempoPot();
 }
 
+/**
+ * the pot only gets read every TEMPO_POT_POLL_INTERVAL, rather than on every pass of the main loop, and its
+ * reading is filtered so ADC noise does not wobble the tempo
+*/
 void Metronome::pollTempoPot() {
-  newTempoPotValue = tempoPot.read_u16();
-  int debounce = 800;
-  if (newTempoPotValue != oldTempoPotValue) {
-    if (newTempoPotValue > oldTempoPotValue + debounce || newTempoPotValue < oldTempoPotValue - debounce)
-    {
-      int index = newTempoPotValue / (65535 / BPM_RANGE);
-      this->updateTempo(usTempoMap[index]);
-      oldTempoPotValue = newTempoPotValue;
+  uint32_t now = scheduler->now();
+  if (now - lastTempoPotRead < TEMPO_POT_POLL_INTERVAL) {
+    return;
+  }
+  lastTempoPotRead = now;
+
+  if (tempoPotFilter.update(tempoPot.read_u16())) {
+    if (externalClock) {
+      if (!clockFollower.holding) {
+        return;               // the external clock sets the tempo
+      }
+      useInternalClock();     // the external clock has stopped, hand tempo control back to the pot
     }
+    this->updateTempo(tempoPotBpm());
+  }
+}
+
+int Metronome::tempoPotBpm() {
+  int index = tempoPotFilter.output / (65535 / BPM_RANGE);
+  if (index > BPM_RANGE - 1) {
+    index = BPM_RANGE - 1;
   }
+  return MIN_BPM + index;
+}
+
+/**
+ * the tick already scheduled keeps its time, so the clock output and every channel position carry on from where
+ * they are. The new tempo (or the first step of a glide towards it) applies from the tick after
+*/
+void Metronome::updateTempo(int _bpm) {
+  core_util_critical_section_enter();
+  bpm = _bpm;
+  timebase.glideTo(bpm);
+  core_util_critical_section_exit();
+}
+
+/**
+ * INTERNAL CLOCK
+ * every tick is scheduled as a one-shot at the absolute time the timebase says it is due. The timebase carries the
+ * fraction of a microsecond each tick lasts, so the long run tempo is exact rather than rounded to whole microseconds
+*/
+void Metronome::startInternalClock() {
+  core_util_critical_section_enter();
+  timebase.start(scheduler->now64());
+  scheduler->scheduleAt(TimerScheduler::CLOCK, callback(this, &Metronome::handleClockTimeout), (uint32_t)timebase.nextTick);
+  core_util_critical_section_exit();
 }
 
-void Metronome::updateTempo(int us) {
-  tickInterval = us;
-  ticker.attach_us(callback(this, &Metronome::tick), tickInterval);
+void Metronome::handleClockTimeout() {
+  timebase.advance();
+  scheduler->scheduleAt(TimerScheduler::CLOCK, callback(this, &Metronome::handleClockTimeout), (uint32_t)timebase.nextTick);
+  this->tick();
+}
+
+/**
+ * EXTERNAL CLOCK
+ * called on every rising edge of the external clock input. Once the follower has measured a period, the internal
+ * CLOCK channel is stopped and all ticks come from the follower - either on the edge itself (the downbeat, plus any
+ * ticks still owed from the previous beat) or from the CLOCK_FOLLOWER channel in between.
+ * NOTE: the edge and the scheduler interrupts share the same NVIC priority, so they never pre-empt each other
+*/
+void Metronome::handleExternalClock() {
+  handleClockEdge(scheduler->now());
+}
+
+/**
+ * SYNC LINK
+ * called by the SyncPort for every beat received from the master unit. The beat is followed just like an external
+ * clock edge (edgeTime being when the master played it), and once it has produced the downbeat, the step and loop
+ * length get snapped to the masters, so every unit is on the same step of the same loop
+*/
+void Metronome::handleSyncBeat(uint32_t edgeTime, int _step, int _numSteps, int _bpm) {
+  counter.numSteps = _numSteps;
+  bpm = _bpm;
+  if (handleClockEdge(edgeTime) > 0) {
+    counter.setPosition(_step, 2);    // the downbeat of _step has just been played
+  }
+}
+
+/**
+ * feed an edge at 'time' to the clock follower, returning the number of ticks it emitted.
+ * The edge which locks the follower takes over from the internal clock part way through a step, so the counter goes
+ * back to the start of that step - the edge plays its downbeat, and every following edge lands on a step boundary
+*/
+int Metronome::handleClockEdge(uint32_t time) {
+  int ticks = clockFollower.edge(time);
+  if (clockFollower.locked && !externalClock) {
+    externalClock = true;
+    scheduler->detach(TimerScheduler::CLOCK);
+    counter.alignToDownbeat();
+  }
+  for (int i = 0; i < ticks; i++) {
+    this->tick();
+  }
+  armFollowerTimeout();
+  return ticks;
+}
+
+void Metronome::handleFollowerTimeout() {
+  uint32_t now = scheduler->now();
+  while (clockFollower.timerArmed && (int32_t)(clockFollower.nextEventTime - now) <= 0) {
+    if (clockFollower.expire(now)) {
+      this->tick();
+    }
+  }
+  armFollowerTimeout();
+}
+
+// schedule the next follower event at its absolute due time, so interrupt latency does not add up
+void Metronome::armFollowerTimeout() {
+  if (clockFollower.timerArmed) {
+    scheduler->scheduleAt(TimerScheduler::CLOCK_FOLLOWER, callback(this, &Metronome::handleFollowerTimeout), clockFollower.nextEventTime);
+  } else {
+    scheduler->detach(TimerScheduler::CLOCK_FOLLOWER);
+  }
+}
+
+void Metronome::useInternalClock() {
+  scheduler->detach(TimerScheduler::CLOCK_FOLLOWER);
+  clockFollower.reset();
+  externalClock = false;
+  startInternalClock();
 }
 
 void Metronome::tick() {
-  if (currTick == 1) {
+  if (counter.tick()) {
     tempoLed.write(1);
-    tempoOutput.write(1);
+    pulses->trigger(&tempoOutput, pulseDuration);
+    if (beatCallbackFn) {
+      beatCallbackFn();
+    }
   } else {
     tempoLed.write(0);
-    tempoOutput.write(0);
   }
-  
-  currTick += 1;
-  position += 1;
 
   // if a callback function exists, call it now
   if (callbackFn) {
     callbackFn();
   }
-
-  if (currTick > ticksPerStep) {
-    this->step();
-  }
-}
-
-void Metronome::step() {
-  currTick = 1;
-  currStep += 1;
-  
-  // reset step count / reset loop
-  if (currStep > numSteps) {
-    currStep = 1;
-    position = 1;
-  }
 }
 
 void Metronome::attachTickCallback(Callback<void()> func) {
   callbackFn = func;
 }
 
+void Metronome::attachBeatCallback(Callback<void()> func) {
+  beatCallbackFn = func;
+}
+
 void Metronome::setNumberOfSteps(int num) {
-  numSteps = num;
+  counter.numSteps = num;
 }
\ No newline at end of file
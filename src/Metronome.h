@@ -9,60 +9,80 @@
 */
 
 #include "main.h"
+#include "ClockFollower.h"
+#include "StepCounter.h"
+#include "TickTimebase.h"
+#include "PotFilter.h"
+#include "TimerScheduler.h"
+#include "PulseGenerator.h"
 
+#define MIN_BPM 40
 #define BPM_RANGE 150
-
-const int usTempoMap[BPM_RANGE] = { 15625, 15243, 14880, 14534, 14204, 13888, 13586, 13297, 13020, 12755, 12500, 12254, 12019, 11792, 11574, 11363, 11160, 10964, 10775, 10593, 10416, 10245, 10080, 9920, 9765, 9615, 9469, 9328, 9191, 9057, 8928, 8802, 8680, 8561, 8445, 8333, 8223, 8116, 8012, 7911, 7812, 7716, 7621, 7530, 7440, 7352, 7267, 7183, 7102, 7022, 6944, 6868, 6793, 6720, 6648, 6578, 6510, 6443, 6377, 6313, 6250, 6188, 6127, 6067, 6009, 5952, 5896, 5841, 5787, 5733, 5681, 5630, 5580, 5530, 5482, 5434, 5387, 5341, 5296, 5252, 5208, 5165, 5122, 5081, 5040, 5000, 4960, 4921, 4882, 4844, 4807, 4770, 4734, 4699, 4664, 4629, 4595, 4562, 4528, 4496, 4464, 4432, 4401, 4370, 4340, 4310, 4280, 4251, 4222, 4194, 4166, 4139, 4111, 4084, 4058, 4032, 4006, 3980, 3955, 3930, 3906, 3881, 3858, 3834, 3810, 3787, 3765, 3742, 3720, 3698, 3676, 3654, 3633, 3612, 3591, 3571, 3551, 3531, 3511, 3491, 3472, 3453, 3434, 3415, 3396, 3378, 3360, 3342, 3324, 3306 };
+#define TEMPO_POT_POLL_INTERVAL 10000 // (us) how often the tempo pot gets read
+#define TEMPO_POT_HYSTERESIS 256      // how far (of 65535) the filtered pot reading has to move before the tempo changes
+#define TEMPO_GLIDE_TICKS 1           // ticks spent on each 1bpm step when gliding to a new tempo, 0 to jump straight to it
+#define EXT_CLOCK_MIN_PERIOD 10000    // (us) faster external clock pulses than this are treated as noise
+#define EXT_CLOCK_MAX_PERIOD 2000000  // (us) slower external clock pulses than this are not used to measure the tempo
 
 class Metronome {
 public:
   AnalogIn tempoPot;
   DigitalOut tempoLed;
   DigitalOut tempoOutput;
-  Ticker ticker; //
+  TimerScheduler *scheduler;    // CLOCK channel drives the internal tempo, CLOCK_FOLLOWER the ticks between external clock pulses
+  PulseGenerator *pulses;       // times the end of each clock output pulse
+  ClockFollower clockFollower;  // tracks the external clock
+  bool externalClock;           // true when ticks are being generated by the external clock instead of the CLOCK channel
+  TickTimebase<PPQN, MIN_BPM, MIN_BPM + BPM_RANGE - 1> timebase; // due time of every internal clock tick
 
   Callback<void()> callbackFn;  // copying how ticker class does it
+  Callback<void()> beatCallbackFn; // called on the first tick of every step
 
-  int tickInterval;          // how long, in microseconds, a tick lasts. 120bpm == 0.5s == 500000us (microseconds)
-  uint16_t newTempoPotValue; // Analog value rep. the position of the potentiometer
-  uint16_t oldTempoPotValue; // Analog value rep. the position of the potentiometer
+  PotFilter<2> tempoPotFilter; // smooths the position of the potentiometer
+  uint32_t lastTempoPotRead;    // time the tempo pot was last read
   uint8_t bpm;
-  uint8_t currStep;       // used to calculate an events position
-  uint8_t numSteps;       // used to calculate total clock loop length (in ticks)
-  uint8_t ticksPerStep;   // equal to PPQN
-  uint8_t currTick;       // relative to PPQN
-  uint16_t position;      // the clocks current position with the loop. Will be a multiplication of currTick and currStep
+  StepCounter counter;    // current step / tick / position within the loop, ticksPerStep equal to PPQN
   uint32_t loopStart;     // time when the first step occurs on the system clock
-  uint32_t pulseDuration; // how long, in microseconds, the clock led will be lit
+  uint32_t pulseDuration; // how long, in microseconds, the clock output pulse lasts
   uint32_t lastClock;     // time of the last clocked event
 
   Metronome(
     PinName ledPin,
     PinName potPin,
     PinName clockOutPin,
-    int ppqn,
-    int defaultNumSteps
-    ) : tempoLed(ledPin), tempoPot(potPin), tempoOutput(clockOutPin)
+    int defaultNumSteps,
+    TimerScheduler *scheduler_ptr,
+    PulseGenerator *pulses_ptr
+    ) : tempoLed(ledPin), tempoPot(potPin), tempoOutput(clockOutPin), clockFollower(PPQN, EXT_CLOCK_MIN_PERIOD, EXT_CLOCK_MAX_PERIOD), timebase(120), tempoPotFilter(TEMPO_POT_HYSTERESIS), counter(PPQN, defaultNumSteps)
   {
-    ticksPerStep = ppqn;
-    numSteps = defaultNumSteps;
-    tickInterval = 5208; // init @ 120bpm ::: (0.5s * 1e+6) / 96ppqn = 5208us
+    scheduler = scheduler_ptr;
+    pulses = pulses_ptr;
     bpm = 120;
-    currStep = 1;
-    currTick = 1;
-    pulseDuration = 5;
+    pulseDuration = CLOCK_PULSE_WIDTH;
+    externalClock = false;
+    timebase.glideTicks = TEMPO_GLIDE_TICKS;
+    lastTempoPotRead = 0;
   };
 
   void init();
   void poll();
   void tick();
-  void step();
   void reset();
   void setNumberOfSteps(int num);
   void handleEncoder();
   void pollTempoPot();
-  void updateTempo(int us);
+  int tempoPotBpm();
+  void updateTempo(int _bpm);
+  void startInternalClock();
+  void handleClockTimeout();
   void attachTickCallback(Callback<void()> func);
+  void attachBeatCallback(Callback<void()> func);
+  void handleExternalClock();
+  void handleSyncBeat(uint32_t edgeTime, int _step, int _numSteps, int _bpm);
+  int handleClockEdge(uint32_t time);
+  void handleFollowerTimeout();
+  void armFollowerTimeout();
+  void useInternalClock();
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,202 @@
+#include "PulseGenerator.h"
+
+/**
+ * set output HIGH now, and back LOW widthUs microseconds from now
+*/
+void PulseGenerator::trigger(DigitalOut *output, uint32_t widthUs) {
+  core_util_critical_section_enter();
+  write(output, true);
+  Output *out = slot(output);
+  if (out) {
+    queue(out, scheduler->now() + widthUs, false, 0);
+    armNextEdge();
+  }
+  core_util_critical_section_exit();
+}
+
+/**
+ * set output HIGH at 'time', and back LOW widthUs microseconds later
+*/
+void PulseGenerator::triggerAt(DigitalOut *output, uint32_t widthUs, uint32_t time, uint8_t tag /* 0 */) {
+  core_util_critical_section_enter();
+  Output *out = slot(output);
+  if (out) {
+    queue(out, time, true, tag);
+    queue(out, time + widthUs, false, tag);
+    armNextEdge();
+  } else {
+    output->write(true);
+  }
+  core_util_critical_section_exit();
+}
+
+/**
+ * set the state of output now, cancelling any edges still pending on it
+*/
+void PulseGenerator::write(DigitalOut *output, bool state) {
+  core_util_critical_section_enter();
+  Output *out = slot(output);
+  if (out) {
+    out->numEdges = 0;
+    set(out, state);
+  } else {
+    output->write(state);
+  }
+  core_util_critical_section_exit();
+}
+
+/**
+ * set the state of output at 'time'. If 'time' has already passed, it gets set right away
+*/
+void PulseGenerator::writeAt(DigitalOut *output, bool state, uint32_t time, uint8_t tag /* 0 */) {
+  core_util_critical_section_enter();
+  Output *out = slot(output);
+  if (out) {
+    queue(out, time, state, tag);
+    armNextEdge();
+  } else {
+    output->write(state);
+  }
+  core_util_critical_section_exit();
+}
+
+/**
+ * drop every edge tagged 'tag' still pending on output, without writing them. Returns how many were dropped
+*/
+int PulseGenerator::cancel(DigitalOut *output, uint8_t tag) {
+  core_util_critical_section_enter();
+  Output *out = slot(output);
+  int cancelled = 0;
+  if (out) {
+    int kept = 0;
+    for (int i = 0; i < out->numEdges; i++) {
+      if (out->edges[i].tag == tag) {
+        cancelled += 1;
+      } else {
+        out->edges[kept++] = out->edges[i];
+      }
+    }
+    out->numEdges = kept;
+    armNextEdge();
+  }
+  core_util_critical_section_exit();
+  return cancelled;
+}
+
+/**
+ * call func (from the PULSE interrupt) just before each tagged edge on output gets written
+*/
+void PulseGenerator::onEdge(DigitalOut *output, Callback<void(uint8_t)> func) {
+  core_util_critical_section_enter();
+  Output *out = slot(output);
+  if (out) {
+    out->onEdge = func;
+    out->hasEdgeCallback = true;
+  }
+  core_util_critical_section_exit();
+}
+
+/**
+ * drive 'combined' as the OR of output and every other output combined into it
+*/
+void PulseGenerator::combine(DigitalOut *output, DigitalOut *combined) {
+  core_util_critical_section_enter();
+  Output *out = slot(output);
+  if (out) {
+    out->combined = combined;
+    set(out, out->state);
+  }
+  core_util_critical_section_exit();
+}
+
+// find the slot belonging to output, or give it a new one. NULL if every slot has been taken
+PulseGenerator::Output *PulseGenerator::slot(DigitalOut *output) {
+  for (int i = 0; i < numOutputs; i++) {
+    if (outputs[i].output == output) {
+      return &outputs[i];
+    }
+  }
+  if (numOutputs == MAX_PULSE_OUTPUTS) {
+    return NULL;
+  }
+  Output *out = &outputs[numOutputs++];
+  out->output = output;
+  out->combined = NULL;
+  out->hasEdgeCallback = false;
+  out->state = output->read();
+  out->numEdges = 0;
+  return out;
+}
+
+// write an output, and the output it is combined into. Must be called from within a critical section
+void PulseGenerator::set(Output *out, bool state) {
+  out->state = state;
+  out->output->write(state);
+  if (out->combined) {
+    bool combinedState = false;
+    for (int i = 0; i < numOutputs; i++) {
+      if (outputs[i].combined == out->combined && outputs[i].state) {
+        combinedState = true;
+      }
+    }
+    out->combined->write(combinedState);
+  }
+}
+
+// write a due edge, calling the outputs onEdge() callback first if it is tagged
+void PulseGenerator::fire(Output *out, Edge *edge) {
+  if (edge->tag && out->hasEdgeCallback) {
+    out->onEdge(edge->tag);
+  }
+  set(out, edge->state);
+}
+
+// insert an edge in time order. When the queue is full, the earliest edge gets written early to make room
+void PulseGenerator::queue(Output *out, uint32_t time, bool state, uint8_t tag) {
+  if (out->numEdges == MAX_PULSE_EDGES) {
+    fire(out, &out->edges[0]);
+    memmove(&out->edges[0], &out->edges[1], (MAX_PULSE_EDGES - 1) * sizeof(Edge));
+    out->numEdges -= 1;
+  }
+  int i = out->numEdges;
+  while (i > 0 && (int32_t)(out->edges[i - 1].time - time) > 0) {
+    out->edges[i] = out->edges[i - 1];
+    i -= 1;
+  }
+  out->edges[i].time = time;
+  out->edges[i].state = state;
+  out->edges[i].tag = tag;
+  out->numEdges += 1;
+}
+
+void PulseGenerator::handleTimeout() {
+  uint32_t now = scheduler->now();
+  for (int i = 0; i < numOutputs; i++) {
+    Output *out = &outputs[i];
+    int due = 0;
+    while (due < out->numEdges && (int32_t)(out->edges[due].time - now) <= 0) {
+      fire(out, &out->edges[due]);
+      due += 1;
+    }
+    if (due) {
+      out->numEdges -= due;
+      memmove(&out->edges[0], &out->edges[due], out->numEdges * sizeof(Edge));
+    }
+  }
+  armNextEdge();
+}
+
+// must be called from within a critical section
+void PulseGenerator::armNextEdge() {
+  Edge *next = NULL;
+  for (int i = 0; i < numOutputs; i++) {
+    if (outputs[i].numEdges && (!next || (int32_t)(outputs[i].edges[0].time - next->time) < 0)) {
+      next = &outputs[i].edges[0];
+    }
+  }
+  if (next) {
+    scheduler->scheduleAt(TimerScheduler::PULSE, callback(this, &PulseGenerator::handleTimeout), next->time);
+  } else {
+    scheduler->detach(TimerScheduler::PULSE);
+  }
+}
@@ -0,0 +1,74 @@
+#ifndef __PULSE_GENERATOR_H
+#define __PULSE_GENERATOR_H
+
+#include "main.h"
+#include "TimerScheduler.h"
+
+/**
+ * PULSE GENERATOR
+ *
+ * Timer driven edges on any DigitalOut. Each output has a small, time ordered queue of pending edges, which get
+ * written from the TimerScheduler PULSE channel at the exact time they are due - so the width of a pulse, or the
+ * timing of a sequenced gate, does not depend on the tempo or on how long the main loop takes to come back around.
+ * The PULSE channel is always armed for whichever pending edge is due first.
+ *
+ * trigger() and write() act immediately, and cancel anything still pending on the output - so a held gate does not
+ * get cut short by the end of an earlier trigger. triggerAt() and writeAt() add to the queue, leaving earlier edges
+ * in place.
+ *
+ * TAGGED EDGES
+ * Edges queued with a (non zero) tag can be taken back with cancel(), leaving every other edge on the output alone.
+ * The outputs onEdge() callback gets called with the tag just before a tagged edge is written, so whatever goes with
+ * the edge (ie. the pitch of a sequenced note) can happen at the same time as it.
+ *
+ * COMBINED OUTPUTS
+ * combine() makes a DigitalOut (ie. the global gate) follow the OR of every output combined into it. It gets
+ * rewritten whenever one of them changes, so each output keeps its own queue of edges and writing one never cancels
+ * the edges pending on another.
+*/
+class PulseGenerator {
+public:
+
+  typedef struct Edge {
+    uint32_t time;      // when the edge is due (see TimerScheduler::now())
+    bool state;         // the state the output gets set to
+    uint8_t tag;        // 0 == untagged, see cancel()
+  } Edge;
+
+  typedef struct Output {
+    DigitalOut *output;
+    DigitalOut *combined;         // follows the OR of every output combined into it, NULL if none
+    bool state;                   // the state last written to output
+    Callback<void(uint8_t)> onEdge; // called with the tag before each tagged edge gets written
+    bool hasEdgeCallback;
+    Edge edges[MAX_PULSE_EDGES];  // pending edges, earliest first
+    int numEdges;
+  } Output;
+
+  TimerScheduler *scheduler;
+  Output outputs[MAX_PULSE_OUTPUTS];
+  int numOutputs;
+
+  PulseGenerator(TimerScheduler *scheduler_ptr) {
+    scheduler = scheduler_ptr;
+    numOutputs = 0;
+  };
+
+  void trigger(DigitalOut *output, uint32_t widthUs);
+  void triggerAt(DigitalOut *output, uint32_t widthUs, uint32_t time, uint8_t tag=0);
+  void write(DigitalOut *output, bool state);
+  void writeAt(DigitalOut *output, bool state, uint32_t time, uint8_t tag=0);
+  int cancel(DigitalOut *output, uint8_t tag);
+  void onEdge(DigitalOut *output, Callback<void(uint8_t)> func);
+  void combine(DigitalOut *output, DigitalOut *combined);
+
+private:
+  Output *slot(DigitalOut *output);
+  void set(Output *out, bool state);
+  void fire(Output *out, Edge *edge);
+  void queue(Output *out, uint32_t time, bool state, uint8_t tag);
+  void handleTimeout();
+  void armNextEdge();
+};
+
+#endif
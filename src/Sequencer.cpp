@@ -1,13 +1,26 @@
 #include "TouchChannel.h"
 
+TouchChannel::SequencePool TouchChannel::eventPool;
+
 void TouchChannel::initSequencer()
 {
     numLoopSteps = DEFAULT_CHANNEL_LOOP_STEPS;
     loopMultiplier = 1;
-    timeQuantizationMode = QUANT_NONE;
+    timeQuantizationGrid.setDivision(GRID_NONE);
+    if (!events) {
+        events = eventPool.acquire();
+    }
+    MBED_ASSERT(events != NULL);  // the pool holds one store per channel, so this only fails if a store has leaked
+    recordOffset = 0;
+    preparedPosition = -1;
+    pitchPending = false;
     currStep = 0;
     currTick = 0;
     currPosition = 0;
+    transportPosition = 0;
+    windowSteps = 0;
+    loopStart = 0;
+    loopStartStep = 0;
     setLoopTotalSteps();
     setLoopTotalPPQN();
     clearEventSequence(); // initialize values in sequence array
@@ -15,112 +28,434 @@ void TouchChannel::initSequencer()
 
 /**
  * Sequence Handler which gets called during polling / every clocking event
+ * Positions without an event cost a single compare against the nextEventPosition cursor. It gets called in every
+ * mode, so the cursor keeps following the play head even while the loop is not being played
 */ 
 void TouchChannel::handleSequence(int position)
 {
+    if (position != nextEventPosition) {
+        ticksSkipped += 1;
+        return;
+    }
+
+    SequenceNode *node = enableLoop ? events->find(position) : NULL;
+
     switch (mode) {
         case MONO_LOOP:
-            if (events[position].active)
+            if (node)
             {
-                if (clearExistingNodes) // when a node is being created (touched degree has not yet been released), this flag gets set to true so that the sequence handler clears existing nodes
+                SequenceNode *prevNode = events->resolve(prevEvent); // NULL if the node has since been deleted or cleared
+
+                if (clearExistingNodes && node == events->resolve(recordingEvent)) // a quantized note ON which got moved ahead of the touch which created it
+                {
+                    prevEvent = recordingEvent;
+                }
+                else if (clearExistingNodes) // when a node is being created (touched degree has not yet been released), this flag gets set to true so that the sequence handler clears existing nodes
                 {
-                    if (events[prevNodePosition].gate == HIGH) // if previous event overlaps new event
+                    if (prevNode && prevNode->gate == HIGH) // if previous event overlaps new event
                     {
                         int newPosition = position == 0 ? totalPPQN : position - 1;
-                        createEvent(newPosition - 1, events[prevNodePosition].noteIndex, LOW); // create a copy of event with gate == LOW @ currPos - 1
-                    }
-                    if (events[position].active) // if new event overlaps succeeding events, overwrite those events
-                    {
-                        clearEvent(position);
+                        createEvent(newPosition - 1, prevNode->noteIndex, LOW); // create a copy of event with gate == LOW @ currPos - 1
                     }
+                    clearEvent(position); // if new event overlaps succeeding events, overwrite those events
                 }
                 else
                 {
-                    if (events[position].gate == HIGH)
+                    bool prepared = position == preparedPosition && node == events->resolve(preparedEvent); // gate already scheduled by prepareNextSequencedNote()
+                    if (node->gate == HIGH)
                     {
-                        prevNodePosition = position;                             // store position into variable
-                        triggerNote(events[position].noteIndex, currOctave, ON); // trigger note ON
+                        prevEvent = events->ref(node);                     // store node reference into variable
+                        if (prepared) {
+                            setNote(node->noteIndex, currOctave);           // the pitch itself goes out with the gate edge
+                            midi->sendNoteOn(channel, calculateMIDINoteValue(node->noteIndex, currOctave), 100);
+                        } else {
+                            triggerNote(node->noteIndex, currOctave, ON);     // trigger note ON
+                        }
                     }
                     else
                     {
-                        if (events[prevNodePosition].noteIndex != events[position].noteIndex)
+                        if (!prevNode || prevNode->noteIndex != node->noteIndex)
                         {
-                            clearEvent(position); // cleanup: if this 'active' LOW node does not match the last active HIGH node, delete it - it is a remnant of a previously deleted node
+                            if (windowSteps == 0) { // the matching HIGH node may lie outside of a FREEZE window
+                                clearEvent(position, false); // cleanup: if this LOW node does not match the last HIGH node, delete it - it is a remnant of a previously deleted node (playback, not an undoable edit)
+                            }
                         }
                         else // set node.gate LOW
                         {
-                            prevNodePosition = position;                              // store position into variable
-                            triggerNote(events[position].noteIndex, currOctave, OFF); // trigger note OFF
+                            prevEvent = events->ref(node);                     // store node reference into variable
+                            if (prepared) {
+                                midi->sendNoteOff(channel, calculateMIDINoteValue(node->noteIndex, currOctave), 100);
+                            } else {
+                                triggerNote(node->noteIndex, currOctave, OFF);    // trigger note OFF
+                            }
                         }
                     }
                 }
             }
             break;
         case QUANTIZE_LOOP:
-            if (events[position].active) {
+            if (node) {
                 if (clearExistingNodes) {
                     clearEvent(position);
                 } else {
-                    setActiveDegrees(events[position].activeNotes);
+                    setActiveDegrees(node->activeNotes);
                 }
                 
             }
             break;
     }
 
-    triggerNote(currNoteIndex, currOctave, PITCH_BEND); // always handle pitch bend value
+    preparedPosition = -1;
+    updateNextEventPosition(position + 1);
 }
 
+/**
+ * SUB-TICK PLAYBACK
+ * The main loop only gets around to a tick some time after it happened, so a note played from handleSequence() is
+ * late by however long that took. Instead, once poll() has caught up with the clock, the next sequenced note gets
+ * prepared one tick ahead: its gate edge is handed to the PulseGenerator to be written by a timer compare at exactly
+ * the next tick plus the notes recorded sub-tick offset. The pitch of a note ON waits for that edge too - the
+ * PulseGenerator calls handlePreparedEdge() just before writing it, and until then the 1v/o output is left alone, so
+ * the note still sounding keeps its pitch. handleSequence() then only has to update the LEDs and send the MIDI message
+ * when it reaches the note.
+ *
+ * The prepared edges are tagged PREPARED_NOTE_EDGE. Anything which moves the play head or the cursor (a reset, the
+ * FREEZE window, a loop length or clock rate change, paste, undo...) takes them back with cancelPreparedNote(), as
+ * does playing a note directly, so recording over a prepared note works the same as before.
+*/
+void TouchChannel::prepareNextSequencedNote()
+{
+    if (mode != MONO_LOOP || !enableLoop || clearExistingNodes) {
+        return;
+    }
+
+    core_util_critical_section_enter();
+    uint32_t tickTime = lastTickTime;
+    uint32_t length = tickLength;
+    bool caughtUp = processedTicks == tickCount;
+    core_util_critical_section_exit();
+    if (!caughtUp || length == 0) {
+        return;
+    }
+
+    int next = currPosition + 1;
+    if (next >= loopEnd) {
+        if (windowSteps > 0) {
+            return; // the FREEZE window shrinks when the loop wraps, so the next position is not known yet
+        }
+        next = loopStart;
+    }
+    if (next != nextEventPosition || next == preparedPosition) {
+        return;
+    }
+
+    SequenceNode *node = events->find(next);
+    if (!node) {
+        return;
+    }
+
+    uint32_t time = tickTime + length + ((node->offset * length) >> 8);
+    if (node->gate == HIGH) {
+        preparedPitch = calculateDACNoteValue(node->noteIndex, currOctave);
+        pitchPending = true;
+        gateOnAt(time, PREPARED_NOTE_EDGE);
+    } else {
+        SequenceNode *prevNode = events->resolve(prevEvent);
+        if (!prevNode || prevNode->noteIndex != node->noteIndex) {
+            return; // a remnant LOW node, handleSequence() cleans it up
+        }
+        gateOffAt(time, PREPARED_NOTE_EDGE);
+    }
+    preparedPosition = next;
+    preparedEvent = events->ref(node);
+    preparedTime = time;
+}
+
+/**
+ * called by the PulseGenerator (from the PULSE interrupt) just before a prepared gate edge gets written
+*/
+void TouchChannel::handlePreparedEdge(uint8_t tag)
+{
+    if (pitchPending) {
+        slew->setTarget(channel, preparedPitch);
+        dacBus->flush();
+        pitchPending = false;
+    }
+}
+
+/**
+ * take back the prepared notes gate edge (and pitch) if it has not gone out yet. If it already has, but
+ * handleSequence() has not got to the note, play the rest of it here so the channel knows the note is sounding
+*/
+void TouchChannel::cancelPreparedNote()
+{
+    if (preparedPosition < 0 && !pitchPending) {
+        return;
+    }
+
+    core_util_critical_section_enter();
+    int cancelled = pulses->cancel(&gateOut, PREPARED_NOTE_EDGE);
+    pitchPending = false;
+    core_util_critical_section_exit();
+
+    if (gateMode == TRIGGER_MODE) {
+        if (cancelled == 1 && gateOut.read() == HIGH) {
+            pulses->writeAt(&gateOut, LOW, preparedTime + triggerWidth); // the trigger already started, let it finish
+        }
+    } else {
+        gateState = gateOut.read();
+    }
+
+    if (preparedPosition >= 0 && cancelled == 0) {
+        SequenceNode *node = events->resolve(preparedEvent);
+        if (node) {
+            prevEvent = preparedEvent;
+            if (node->gate == HIGH) {
+                setNote(node->noteIndex, currOctave);
+                midi->sendNoteOn(channel, calculateMIDINoteValue(node->noteIndex, currOctave), 100);
+            }
+        }
+    }
+    preparedPosition = -1;
+}
+
+/**
+ * the position the current touch actually happened at. poll() may have moved on by a few ticks since the touch
+ * interrupt fired (or not yet caught up with the tick it fired in), so step back (or forward) by the difference
+ * between the ticks processed and the tick count captured by the interrupt, wrapping within the loop.
+ * 'tick', if given, is set to how far into its step the touch happened (0..PPQN-1).
+ * NOTE: |ticksSince| is under PPQN and the loop is at least one step long, so a single compare-and-add wraps both
+ * values - no divides on the record path
+*/
+int TouchChannel::touchPosition(int *tick /* NULL */)
+{
+    int ticksSince = (int32_t)(processedTicks - currTouch.tickCount);
+    if (ticksSince >= PPQN || ticksSince <= -PPQN) {
+        ticksSince = 0; // the touch was held back on purpose (ie. while frozen), not by the main loop
+    } else if (ticksSince > 0) {
+        touchStats.compensatedTicks += ticksSince;
+    }
+    if (tick) {
+        int touchedTick = currTick - ticksSince;
+        if (touchedTick < 0) {
+            touchedTick += PPQN;
+        } else if (touchedTick >= PPQN) {
+            touchedTick -= PPQN;
+        }
+        *tick = touchedTick;
+    }
+    int length = loopEnd - loopStart;
+    int position = currPosition - loopStart - ticksSince;
+    if (position < 0) {
+        position += length;
+    } else if (position >= length) {
+        position -= length;
+    }
+    return loopStart + position;
+}
+
+/**
+ * how far into its tick the current touch happened, in 1/256ths of a tick. 0 when the touch is being snapped to
+ * the record quantization grid anyway
+*/
+uint8_t TouchChannel::recordSubTick()
+{
+    uint32_t length = tickLength;
+    if (timeQuantizationGrid.division != GRID_NONE || length == 0) {
+        return 0;
+    }
+
+    uint32_t elapsed = currTouch.time - currTouch.tickTime;
+    if (elapsed >= length) {
+        return 255;
+    }
+    return (elapsed << 8) / length;
+}
+
+/**
+ * point the nextEventPosition cursor at the first event at or after the given position,
+ * wrapping around to the start of the loop. Events outside of the loop (or FREEZE window) are ignored.
+*/
+void TouchChannel::updateNextEventPosition(int position)
+{
+    if (!events) {
+        nextEventPosition = -1;
+        firstEventPosition = -1;
+        return;
+    }
+    int firstIndex = loopStart == 0 ? 0 : events->lowerBound(loopStart);
+    int first = (firstIndex < events->size() && events->positionAt(firstIndex) < loopEnd) ? events->positionAt(firstIndex) : -1;
+    int i = events->lowerBound(position);
+
+    if (i < events->size() && events->positionAt(i) < loopEnd) {
+        nextEventPosition = events->positionAt(i);
+    } else {
+        nextEventPosition = first;
+    }
+    firstEventPosition = first;
+}
+
+/**
+ * re-calculate the cursor after the sequence has been modified. currPosition has always been handled by the time
+ * the sequence gets modified, so the search starts from the following position.
+*/
+void TouchChannel::refreshNextEventPosition()
+{
+    updateNextEventPosition(currPosition + 1);
+}
+
+/**
+ * O(1), existing nodes are invalidated by the EventStore generation rather than being cleared one by one
+*/
 void TouchChannel::clearEventSequence()
 {
-    // deactivate all events in list
-    for (int i = 0; i < PPQN * MAX_SEQ_STEPS; i++)
-    {
-        clearEvent(i);
+    if (!events) { return; }
+    cancelPreparedNote();
+    if (eventPool.isShared(events)) { // leave the other channels copy of the sequence alone, and start over with an empty store
+        eventPool.release(events);
+        events = eventPool.acquire();
     }
+    events->clear();
+    undoJournal.clear();
+    clearPitchBendSequence();
     sequenceContainsEvents = false; // after deactivating all events in list, set this flag to false
+    nextEventPosition = -1;
+    firstEventPosition = -1;
 };
 
 void TouchChannel::clearPitchBendSequence()
 {
-    // deactivate all events in list
-    for (int i = 0; i < PPQN * MAX_SEQ_STEPS; i++)
-    {
-        events[i].pitchBend = pbZero;
-    }
+    pitchBendLane.clear(pbZero);
 };
 
-void TouchChannel::createEvent(int position, int noteIndex, bool gate)
+void TouchChannel::createEvent(int position, int noteIndex, bool gate, uint8_t offset /* 0 */)
 {
+    prepareEventsForWrite();
+    undoJournal.record(position, events->find(position));
+    SequenceNode *node = events->insert(position);
+    if (!node) { return; } // event store is full, drop the event
+
     if (sequenceContainsEvents == false) { sequenceContainsEvents = true; }
 
-    events[position].noteIndex = noteIndex;
-    events[position].gate = gate;
-    events[position].active = true;
+    node->noteIndex = noteIndex;
+    node->gate = gate;
+    node->offset = offset;
+    refreshNextEventPosition();
 };
 
 void TouchChannel::createPitchBendEvent(int position, uint16_t pitchBend) {
     if (sequenceContainsEvents == false) { sequenceContainsEvents = true; }
 
-    events[position].pitchBend = pitchBend;
+    pitchBendLane.record(position, pitchBend, pbDebounce);
 }
 
-void TouchChannel::clearEvent(int position)
+/**
+ * undoable: false for housekeeping done during playback, which must not end up in the current recording pass
+*/
+void TouchChannel::clearEvent(int position, bool undoable /* true */)
 {
-    events[position].noteIndex = NULL_NOTE_INDEX;
-    events[position].active = false;
-    events[position].gate = LOW;
-    events[position].pitchBend = pbZero;
+    SequenceNode *node = events->find(position);
+    if (!node) { return; }
+    if (undoable) {
+        undoJournal.record(position, node);
+    }
+    prepareEventsForWrite();
+    if (events->remove(position)) {
+        refreshNextEventPosition();
+    }
 }
 
 void TouchChannel::createChordEvent(int position, uint8_t notes)
 {
+    prepareEventsForWrite();
+    undoJournal.record(position, events->find(position));
+    SequenceNode *node = events->insert(position);
+    if (!node) { return; } // event store is full, drop the event
 
     if (sequenceContainsEvents == false)
     {
         sequenceContainsEvents = true;
     }
 
-    events[position].activeNotes = notes;
-    events[position].active = true;
-};
\ No newline at end of file
+    node->activeNotes = notes;
+    refreshNextEventPosition();
+};
+
+/**
+ * snap a recorded position to the channels record quantization grid
+ * tick: the position within the current step (currTick), used to index the grids pre-computed offsets
+*/
+int TouchChannel::quantizePosition(int position, int tick)
+{
+    return timeQuantizationGrid.snap(position, tick, totalPPQN);
+}
+
+void TouchChannel::setTimeQuantization(GridDivision division)
+{
+    timeQuantizationGrid.setDivision(division);
+    if (uiMode == LOOP_LENGTH_UI) {
+        updateLoopLengthUI();
+    }
+}
+
+// step through each grid division: NONE -> 1/4 -> 1/8 -> 1/16 -> 1/32 -> 1/8T -> 1/16T -> 1/32T -> NONE
+void TouchChannel::cycleTimeQuantization()
+{
+    setTimeQuantization((GridDivision)((timeQuantizationGrid.division + 1) % NUM_GRID_DIVISIONS));
+}
+
+/**
+ * a pasted sequence shares its event store with the channel it was copied from. Before modifying the store,
+ * give this channel its own copy if it is still being shared. References to nodes (prevEvent etc.) stay valid,
+ * since the copy is identical to the original
+*/
+void TouchChannel::prepareEventsForWrite()
+{
+    SequencePool::Store *writable = eventPool.makeWritable(events);
+    if (writable) {
+        events = writable;
+    }
+}
+
+/**
+ * copy another channels sequence into this channel. Nothing gets copied here, both channels point at the
+ * same event store until one of them records / clears an event (see prepareEventsForWrite())
+ * NOTE: the loop length is copied along with the events, the pitch bend automation is not
+*/
+void TouchChannel::pasteSequence(TouchChannel *source)
+{
+    if (source == this || !events || !source->events) { return; }
+    cancelPreparedNote();
+
+    eventPool.retain(source->events);
+    eventPool.release(events);
+    events = source->events;
+    undoJournal.clear();
+
+    prevEvent.slot = 0xFFFF;      // references into the old store are meaningless in the new one
+    recordingEvent.slot = 0xFFFF;
+    clearExistingNodes = false;
+    sequenceContainsEvents = !events->isEmpty() || !pitchBendLane.isEmpty();
+
+    numLoopSteps = source->numLoopSteps;
+    loopMultiplier = source->loopMultiplier;
+    setLoopTotalSteps();
+    setLoopTotalPPQN(); // also repositions the sequence cursor within the new events
+    if (uiMode == LOOP_LENGTH_UI) {
+        updateLoopLengthUI();
+    }
+}
+
+/**
+ * restore every event modified during the most recent recording pass
+*/
+void TouchChannel::undoLastPass()
+{
+    if (!events || undoJournal.size() == 0) { return; }
+    cancelPreparedNote();
+    prepareEventsForWrite();
+    if (undoJournal.undoLastPass(*events)) {
+        clearExistingNodes = false;
+        refreshNextEventPosition();
+    }
+}
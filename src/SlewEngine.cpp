@@ -0,0 +1,99 @@
+#include "SlewEngine.h"
+
+SlewEngine *SlewEngine::instance = NULL;
+
+void SlewEngine::init() {
+  instance = this;
+
+  RCC->APB1ENR |= RCC_APB1ENR_TIM7EN;
+  uint32_t timerClock = HAL_RCC_GetPCLK1Freq();
+  if ((RCC->CFGR & RCC_CFGR_PPRE1) != RCC_CFGR_PPRE1_DIV1) {
+    timerClock *= 2;                                  // APB1 timers run at twice PCLK1 whenever APB1 is divided down
+  }
+
+  TIM7->CR1 = 0;
+  TIM7->PSC = timerClock / 1000000 - 1;               // count microseconds
+  TIM7->ARR = 1000000 / SLEW_UPDATE_RATE - 1;
+  TIM7->EGR = TIM_EGR_UG;                             // load the prescaler
+  TIM7->SR = 0;
+  TIM7->DIER = TIM_DIER_UIE;
+  TIM7->CR1 = TIM_CR1_CEN;
+
+  NVIC_SetVector(TIM7_IRQn, (uint32_t)&SlewEngine::irqHandler);
+  NVIC_SetPriority(TIM7_IRQn, SLEW_IRQ_PRIORITY);
+  NVIC_EnableIRQ(TIM7_IRQn);
+
+  resetStats();
+}
+
+/**
+ * the channels new 1v/o DAC code. Glides there if the channel has a slew time set, otherwise it goes straight into
+ * the DacBus frame
+*/
+void SlewEngine::setTarget(int chan, uint16_t code) {
+  core_util_critical_section_enter();
+  if (slews[chan].isEnabled()) {
+    slews[chan].setTarget(code);
+  } else {
+    slews[chan].jump(code);
+    bus->frame.write(DAC_PITCH, chan, code);
+  }
+  core_util_critical_section_exit();
+}
+
+void SlewEngine::setTime(int chan, int index) {
+  Slew timing;                                        // work out the coefficient outside of the critical section
+  timing.setTimeConstant(SLEW_TIMES[index], SLEW_UPDATE_RATE);
+
+  core_util_critical_section_enter();
+  timeIndex[chan] = index;
+  slews[chan].coefficient = timing.coefficient;
+  if (!slews[chan].isEnabled() && slews[chan].isGliding()) {
+    slews[chan].current = slews[chan].target;         // gliding turned off part way, finish it now
+    bus->frame.write(DAC_PITCH, chan, slews[chan].output());
+  }
+  core_util_critical_section_exit();
+}
+
+void SlewEngine::cycleTime(int chan) {
+  setTime(chan, (timeIndex[chan] + 1) % NUM_SLEW_TIMES);
+}
+
+void SlewEngine::resetStats() {
+  memset(&stats, 0, sizeof(Stats));
+}
+
+void SlewEngine::irqHandler() {
+  instance->handleUpdate();
+}
+
+void SlewEngine::handleUpdate() {
+  TIM7->SR = 0;
+  if (paused) {
+    return;
+  }
+
+  uint32_t start = DWT->CYCCNT;
+  int stepped = 0;
+  for (int chan = 0; chan < NUM_CHANNELS; chan++) {
+    if (!slews[chan].isGliding()) continue;
+    uint32_t stepStart = DWT->CYCCNT;
+    bus->frame.write(DAC_PITCH, chan, slews[chan].update());
+    uint32_t stepCycles = DWT->CYCCNT - stepStart;
+    if (stepCycles > stats.maxStepCycles) {
+      stats.maxStepCycles = stepCycles;
+    }
+    stepped += 1;
+  }
+  if (stepped == 0) {
+    return;
+  }
+  bus->flush();
+
+  stats.updates += 1;
+  stats.steps += stepped;
+  stats.lastUpdateCycles = DWT->CYCCNT - start;
+  if (stats.lastUpdateCycles > stats.maxUpdateCycles) {
+    stats.maxUpdateCycles = stats.lastUpdateCycles;
+  }
+}
@@ -0,0 +1,66 @@
+#ifndef __SLEW_ENGINE_H
+#define __SLEW_ENGINE_H
+
+#include "main.h"
+#include "Slew.h"
+#include "DacBus.h"
+
+/**
+ * SLEW ENGINE
+ *
+ * Portamento for the four 1v/o outputs. Channels hand their pitch to setTarget() instead of writing the DAC, and
+ * each output glides to it with its own time constant, chosen from SLEW_TIMES (channel n == DAC_PITCH channel n).
+ *
+ * Gliding runs off the update interrupt of TIM7, a basic timer with no pins which is otherwise unused, at a fixed
+ * SLEW_UPDATE_RATE. Each update steps every gliding output (see Slew) straight into the DacBus frame and flushes it.
+ * Outputs with gliding turned off skip the interrupt altogether - setTarget() writes them into the frame right away,
+ * exactly as before, and so does an output which has finished its glide.
+ *
+ * TIM7 sits at SLEW_IRQ_PRIORITY, below the clock and UI interrupts, so a clock edge or tick always pre-empts an
+ * update rather than waiting on it.
+ *
+ * Set 'paused' while something other than the DacBus is driving the DACs (calibration), and updates do nothing.
+ *
+ * STATS
+ * The cost of each update, and of each output stepped within it (in CPU cycles, from the DWT cycle counter), are kept
+ * in 'stats'. Stepping an output costs the same no matter how far it has to go, so maxStepCycles * NUM_CHANNELS
+ * (plus the flush) bounds an update. Read them with a debugger.
+*/
+class SlewEngine {
+public:
+
+  typedef struct Stats {
+    uint32_t updates;             // updates in which at least one output was gliding
+    uint32_t steps;               // outputs stepped, across every update
+    uint32_t maxStepCycles;       // worst cost of stepping a single output and writing it into the frame
+    uint32_t maxUpdateCycles;     // worst cost of a whole update, including the flush
+    uint32_t lastUpdateCycles;    // cost of the most recent update
+  } Stats;
+
+  DacBus *bus;
+  Slew slews[NUM_CHANNELS];
+  int timeIndex[NUM_CHANNELS];    // index into SLEW_TIMES
+  volatile bool paused;
+  Stats stats;
+
+  SlewEngine(DacBus *bus_ptr) {
+    bus = bus_ptr;
+    paused = false;
+    for (int chan = 0; chan < NUM_CHANNELS; chan++) {
+      timeIndex[chan] = 0;
+    }
+  };
+
+  void init();
+  void setTarget(int chan, uint16_t code);
+  void setTime(int chan, int index);
+  void cycleTime(int chan);
+  void resetStats();
+
+private:
+  static SlewEngine *instance;
+  static void irqHandler();
+  void handleUpdate();
+};
+
+#endif
@@ -0,0 +1,114 @@
+#include "SyncPort.h"
+
+void SyncPort::init() {
+  serial.attach(callback(this, &SyncPort::handleRx), RawSerial::RxIrq);
+  NVIC_SetPriority(UART5_IRQn, EXT_CLOCK_IRQ_PRIORITY);
+  metronome->attachBeatCallback(callback(this, &SyncPort::handleBeat));
+}
+
+/**
+ * call from the main loop. Returns true once for every reset received from the master
+*/
+bool SyncPort::poll() {
+  if (role == FOLLOWER && scheduler->now() - lastFrameTime > SYNC_TIMEOUT) {
+    role = MASTER;                                    // the master has gone quiet, carry on at the held tempo
+  }
+
+  if (resetReceived) {
+    resetReceived = false;
+    return true;
+  }
+  return false;
+}
+
+void SyncPort::sendReset() {
+  if (role != MASTER) {
+    return;
+  }
+  SyncFrame frame;
+  frame.type = SYNC_RESET;
+  frame.hops = 0;
+  frame.step = metronome->counter.currStep;
+  frame.numSteps = metronome->counter.numSteps;
+  frame.bpm = metronome->bpm;
+  core_util_critical_section_enter();
+  frame.seq = seq++;
+  send(frame);
+  core_util_critical_section_exit();
+}
+
+/**
+ * called by the metronome on the downbeat of every step
+*/
+void SyncPort::handleBeat() {
+  if (role != MASTER) {
+    return;
+  }
+  SyncFrame frame;
+  frame.type = SYNC_BEAT;
+  frame.hops = 0;
+  frame.step = metronome->counter.currStep;
+  frame.numSteps = metronome->counter.numSteps;
+  frame.bpm = metronome->bpm;
+  core_util_critical_section_enter();   // same as sendReset(), so nothing depends on the clock and UART5 priorities matching
+  frame.seq = seq++;
+  send(frame);
+  core_util_critical_section_exit();
+}
+
+void SyncPort::handleRx() {
+  while (serial.readable()) {
+    if (decoder.receive(serial.getc())) {
+      handleFrame(scheduler->now());
+    }
+  }
+}
+
+void SyncPort::handleFrame(uint32_t now) {
+  SyncFrame frame = decoder.frame;
+  role = FOLLOWER;
+  lastFrameTime = now;
+
+  if (frame.hops < 255) {
+    frame.hops += 1;
+    send(frame);                                      // pass it on down the chain
+  }
+
+  switch (frame.type) {
+    case SYNC_BEAT:
+      metronome->handleSyncBeat(now - frameTime * frame.hops, frame.step, frame.numSteps, frame.bpm);
+      break;
+    case SYNC_RESET:
+      resetReceived = true;
+      break;
+  }
+}
+
+/**
+ * queue a frame for sending. Frames which do not fit in the buffer are dropped (followers count them as lost).
+ * Must be called from the UART5 interrupt priority, or within a critical section
+*/
+void SyncPort::send(SyncFrame frame) {
+  if ((uint16_t)(txHead - txTail) > SYNC_TX_BUFFER_SIZE - SYNC_FRAME_LENGTH) {
+    return;
+  }
+  uint8_t bytes[SYNC_FRAME_LENGTH];
+  SyncLink::encode(frame, bytes);
+  for (int i = 0; i < SYNC_FRAME_LENGTH; i++) {
+    txBuffer[txHead++ & (SYNC_TX_BUFFER_SIZE - 1)] = bytes[i];
+  }
+  if (!txActive) {
+    txActive = true;
+    serial.attach(callback(this, &SyncPort::handleTx), RawSerial::TxIrq);
+  }
+}
+
+void SyncPort::handleTx() {
+  while (txHead != txTail && serial.writeable()) {
+    serial.putc(txBuffer[txTail++ & (SYNC_TX_BUFFER_SIZE - 1)]);
+  }
+  if (txHead == txTail) {
+    serial.attach(Callback<void()>(), RawSerial::TxIrq);
+    txActive = false;
+  }
+}
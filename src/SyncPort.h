@@ -0,0 +1,75 @@
+#ifndef __SYNC_PORT_H
+#define __SYNC_PORT_H
+
+#include "main.h"
+#include "SyncLink.h"
+#include "TimerScheduler.h"
+#include "Metronome.h"
+
+/**
+ * SYNC PORT
+ *
+ * Keeps several units in time with each other over SYNC_TX / SYNC_RX (UART5), using the frames in SyncLink.h.
+ *
+ * A unit starts out as the MASTER, and sends a SYNC_BEAT frame on the downbeat of every step, plus a SYNC_RESET
+ * frame whenever its channels get reset. As soon as it receives a valid frame it becomes a FOLLOWER: it stops sending
+ * frames of its own, relays the ones it receives, and:
+ *  - phase locks its Metronome to the beats, through the same ClockFollower as the external clock input. The edge
+ *    time handed to the follower is the time the frame finished arriving minus its time on the wire, so the link adds
+ *    no phase offset
+ *  - snaps its step and loop length to the masters at every beat
+ *  - resets its channels when the master does (from poll(), not the interrupt)
+ * If no frame arrives for SYNC_TIMEOUT the unit goes back to being a MASTER, carrying on at the held tempo.
+ *
+ * Bytes are received and sent from the UART5 interrupt, at EXT_CLOCK_IRQ_PRIORITY so decoding a beat never
+ * pre-empts (or gets pre-empted by) the scheduler callbacks which share the ClockFollower.
+*/
+class SyncPort {
+public:
+  enum Role {
+    MASTER,
+    FOLLOWER
+  };
+
+  RawSerial serial;
+  TimerScheduler *scheduler;
+  Metronome *metronome;
+  SyncDecoder decoder;
+  Role role;
+  uint8_t seq;                // sequence number of the next frame sent as master
+  uint32_t lastFrameTime;     // when the last valid frame was received
+  uint32_t frameTime;         // how long a frame takes on the wire (us)
+  volatile bool resetReceived;// set by the interrupt, handled by poll()
+
+  SyncPort(PinName txPin, PinName rxPin, TimerScheduler *scheduler_ptr, Metronome *metronome_ptr) : serial(txPin, rxPin, SYNC_BAUD)
+  {
+    scheduler = scheduler_ptr;
+    metronome = metronome_ptr;
+    role = MASTER;
+    seq = 0;
+    lastFrameTime = 0;
+    frameTime = SyncLink::frameTimeUs(SYNC_BAUD);
+    resetReceived = false;
+    txHead = 0;
+    txTail = 0;
+    txActive = false;
+  };
+
+  void init();
+  bool poll();
+  void sendReset();
+
+private:
+  uint8_t txBuffer[SYNC_TX_BUFFER_SIZE];  // ring buffer, SYNC_TX_BUFFER_SIZE must be a power of 2
+  uint16_t txHead;
+  uint16_t txTail;
+  bool txActive;
+
+  void handleBeat();
+  void handleRx();
+  void handleTx();
+  void handleFrame(uint32_t now);
+  void send(SyncFrame frame);
+};
+
+#endif
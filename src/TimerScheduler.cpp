@@ -0,0 +1,161 @@
+#include "TimerScheduler.h"
+
+TimerScheduler *TimerScheduler::instance = NULL;
+
+void TimerScheduler::init() {
+  instance = this;
+
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;    // enable the DWT cycle counter, used for stats
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+  RCC->APB1ENR |= RCC_APB1ENR_TIM2EN;
+  uint32_t timerClock = HAL_RCC_GetPCLK1Freq();
+  if ((RCC->CFGR & RCC_CFGR_PPRE1) != RCC_CFGR_PPRE1_DIV1) {
+    timerClock *= 2;                                  // APB1 timers run at twice PCLK1 whenever APB1 is divided down
+  }
+
+  TIM2->CR1 = 0;
+  TIM2->PSC = timerClock / 1000000 - 1;               // count microseconds
+  TIM2->ARR = 0xFFFFFFFF;                             // free running, 32-bit
+  TIM2->CCMR1 = 0;                                    // output compare channels, with no pin output
+  TIM2->CCMR2 = 0;
+  TIM2->CCER = 0;
+  TIM2->EGR = TIM_EGR_UG;                             // load the prescaler
+  TIM2->SR = 0;
+  TIM2->DIER = TIM_DIER_UIE;                          // overflow, see now64()
+  TIM2->CR1 = TIM_CR1_CEN;
+
+  NVIC_SetVector(TIM2_IRQn, (uint32_t)&TimerScheduler::irqHandler);
+  NVIC_SetPriority(TIM2_IRQn, TIMER_SCHEDULER_IRQ_PRIORITY);
+  NVIC_EnableIRQ(TIM2_IRQn);
+
+  resetStats();
+
+  // for comparison, the cost of inserting a single event into mbed's shared us_ticker queue
+  Timeout probe;
+  uint32_t start = DWT->CYCCNT;
+  probe.attach_us(callback(this, &TimerScheduler::resetStats), 1000000);
+  stats.usTickerInsertCycles = DWT->CYCCNT - start;
+  probe.detach();
+}
+
+/**
+ * microseconds since init(), as a 64-bit count which never wraps
+*/
+uint64_t TimerScheduler::now64() {
+  core_util_critical_section_enter();
+  uint64_t time = counter.extend(TIM2->CNT);
+  core_util_critical_section_exit();
+  return time;
+}
+
+/**
+ * call func every periodUs microseconds, starting one period from now
+*/
+void TimerScheduler::attach(Channel channel, Callback<void()> func, uint32_t periodUs) {
+  core_util_critical_section_enter();
+  callbacks[channel] = func;
+  periods[channel] = periodUs;
+  arm(channel, now() + periodUs);
+  core_util_critical_section_exit();
+}
+
+/**
+ * call func once, delayUs microseconds from now
+*/
+void TimerScheduler::schedule(Channel channel, Callback<void()> func, uint32_t delayUs) {
+  scheduleAt(channel, func, now() + delayUs);
+}
+
+/**
+ * call func once, when the timer reaches 'time' (see now()). If 'time' has already passed, func gets called right away
+*/
+void TimerScheduler::scheduleAt(Channel channel, Callback<void()> func, uint32_t time) {
+  core_util_critical_section_enter();
+  callbacks[channel] = func;
+  periods[channel] = 0;
+  arm(channel, time);
+  core_util_critical_section_exit();
+}
+
+void TimerScheduler::detach(Channel channel) {
+  core_util_critical_section_enter();
+  TIM2->DIER &= ~(TIM_DIER_CC1IE << channel);
+  TIM2->SR = ~(TIM_SR_CC1IF << channel);
+  core_util_critical_section_exit();
+}
+
+void TimerScheduler::resetStats() {
+  uint32_t insertCycles = stats.usTickerInsertCycles;
+  memset(&stats, 0, sizeof(Stats));
+  stats.usTickerInsertCycles = insertCycles;
+}
+
+// must be called from within a critical section
+void TimerScheduler::arm(Channel channel, uint32_t time) {
+  uint32_t start = DWT->CYCCNT;
+
+  *compareRegister(channel) = time;
+  TIM2->SR = ~(TIM_SR_CC1IF << channel);              // clear any stale match (SR bits are cleared by writing 0)
+  TIM2->DIER |= TIM_DIER_CC1IE << channel;
+  if ((int32_t)(TIM2->CNT - time) >= 0) {
+    TIM2->EGR = TIM_EGR_CC1G << channel;              // already due (or passed while arming), fire now
+  }
+
+  stats.lastScheduleCycles = DWT->CYCCNT - start;
+  if (stats.lastScheduleCycles > stats.maxScheduleCycles) {
+    stats.maxScheduleCycles = stats.lastScheduleCycles;
+  }
+}
+
+volatile uint32_t *TimerScheduler::compareRegister(Channel channel) {
+  return &TIM2->CCR1 + channel;                       // CCR1..CCR4 are consecutive registers
+}
+
+void TimerScheduler::irqHandler() {
+  instance->handleInterrupt();
+}
+
+void TimerScheduler::handleInterrupt() {
+  uint32_t start = DWT->CYCCNT;
+  stats.interrupts += 1;
+
+  uint32_t status = TIM2->SR & TIM2->DIER;
+  if (status & TIM_SR_UIF) {
+    TIM2->SR = ~TIM_SR_UIF;
+    now64();                                          // TIM2 wrapped
+  }
+  for (int i = 0; i < NUM_TIMER_CHANNELS; i++) {
+    uint32_t flag = TIM_SR_CC1IF << i;
+    if (!(status & flag)) {
+      continue;
+    }
+    TIM2->SR = ~flag;
+
+    volatile uint32_t *ccr = compareRegister((Channel)i);
+    uint32_t due = *ccr;
+    uint32_t latency = TIM2->CNT - due;
+    if (latency > stats.maxLatencyUs) {
+      stats.maxLatencyUs = latency;
+    }
+
+    if (periods[i]) {
+      *ccr = due + periods[i];                        // relative to when it was due, not when it ran, so no drift
+      if ((int32_t)(TIM2->CNT - *ccr) >= 0) {
+        TIM2->EGR = TIM_EGR_CC1G << i;                // serviced more than a whole period late
+      }
+    } else {
+      TIM2->DIER &= ~(TIM_DIER_CC1IE << i);           // one-shot. The callback is free to schedule itself again
+    }
+
+    stats.callbacks += 1;
+    callbacks[i].call();
+  }
+
+  uint32_t cycles = DWT->CYCCNT - start;
+  stats.totalIsrCycles += cycles;
+  if (cycles > stats.maxIsrCycles) {
+    stats.maxIsrCycles = cycles;
+  }
+}
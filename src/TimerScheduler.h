@@ -0,0 +1,92 @@
+#ifndef __TIMER_SCHEDULER_H
+#define __TIMER_SCHEDULER_H
+
+#include "main.h"
+#include "TickTimebase.h"
+
+/**
+ * TIMER SCHEDULER
+ *
+ * All of the modules time based callbacks run off the four output compare channels of TIM2, a free running 32-bit
+ * timer counting microseconds. Each callback owns one compare channel, so scheduling is just writing a compare
+ * register - there is no shared event queue to insert into (unlike mbed's Ticker / Timeout, which all share the
+ * us_ticker queue).
+ *
+ * TIM2 wraps every ~71 minutes, so now64() extends it into a 64-bit count which never wraps. The TIM2 update
+ * (overflow) interrupt is enabled just to keep the extension up to date when nothing else is calling now64().
+ *
+ * Periodic callbacks are re-armed by adding their period to the compare register, so they never drift no matter
+ * how late the interrupt gets serviced. One-shot callbacks disable their channel once fired.
+ *
+ * PRIORITIES
+ * Every channel shares the TIM2 interrupt, at TIMER_SCHEDULER_IRQ_PRIORITY. When several channels are due at the
+ * same time they run in channel order (CLOCK first). The external clock input interrupt is set to the same priority,
+ * so it never pre-empts (or gets pre-empted by) any of these callbacks:
+ *
+ *   channel          callback                            priority
+ *   CLOCK            Metronome::handleClockTimeout       TIMER_SCHEDULER_IRQ_PRIORITY
+ *   CLOCK_FOLLOWER   Metronome::handleFollowerTimeout    TIMER_SCHEDULER_IRQ_PRIORITY
+ *   CALIBRATION      VCOCalibrator::sampleVCOFrequency   TIMER_SCHEDULER_IRQ_PRIORITY
+ *   PULSE            PulseGenerator::handleTimeout       TIMER_SCHEDULER_IRQ_PRIORITY
+ *
+ * The touch / IO expander interrupts (see ExtiDispatcher) sit below it at UI_IRQ_PRIORITY, so a clock edge or tick
+ * pre-empts them rather than queueing up behind them. mbed leaves every other interrupt (us_ticker, I2C) at priority
+ * 0 too, so none of them pre-empt a scheduler callback - when several are pending at once, the NVIC takes them in IRQ
+ * number order.
+ *
+ * STATS
+ * ISR entry latency (compare match -> callback, in us), ISR duration and the cost of arming a channel (in CPU
+ * cycles, from the DWT cycle counter) are recorded in 'stats', along with the cost of a single mbed Timeout insert
+ * measured at init() for comparison. Read them with a debugger.
+*/
+class TimerScheduler {
+public:
+
+  enum Channel {
+    CLOCK = 0,
+    CLOCK_FOLLOWER = 1,
+    CALIBRATION = 2,
+    PULSE = 3,
+    NUM_TIMER_CHANNELS = 4
+  };
+
+  typedef struct Stats {
+    uint32_t interrupts;          // number of TIM2 interrupts serviced
+    uint32_t callbacks;           // number of callbacks run
+    uint32_t maxLatencyUs;        // worst time between a compare match and its callback starting
+    uint32_t maxIsrCycles;        // worst duration of a whole TIM2 interrupt (including callbacks)
+    uint32_t totalIsrCycles;      // sum of all interrupt durations, divide by 'interrupts' for the average
+    uint32_t maxScheduleCycles;   // worst cost of arming a channel
+    uint32_t lastScheduleCycles;  // cost of the most recent arming of a channel
+    uint32_t usTickerInsertCycles;// cost of attaching a single mbed Timeout, measured once at init()
+  } Stats;
+
+  Callback<void()> callbacks[NUM_TIMER_CHANNELS];
+  uint32_t periods[NUM_TIMER_CHANNELS];         // 0 for one-shot callbacks
+  Stats stats;
+  WrapCounter counter;                          // extends TIM2 to 64 bits
+
+  TimerScheduler() {
+    for (int i = 0; i < NUM_TIMER_CHANNELS; i++) {
+      periods[i] = 0;
+    }
+  };
+
+  void init();
+  uint32_t now() { return TIM2->CNT; }
+  uint64_t now64();
+  void attach(Channel channel, Callback<void()> func, uint32_t periodUs);
+  void schedule(Channel channel, Callback<void()> func, uint32_t delayUs);
+  void scheduleAt(Channel channel, Callback<void()> func, uint32_t time);
+  void detach(Channel channel);
+  void resetStats();
+
+private:
+  static TimerScheduler *instance;
+  static void irqHandler();
+  void handleInterrupt();
+  void arm(Channel channel, uint32_t time);
+  volatile uint32_t *compareRegister(Channel channel);
+};
+
+#endif
@@ -2,6 +2,11 @@
 
 void TouchChannel::init() {
 
+  exti->attach(touchIntPin, ExtiDispatcher::FALLING, callback(this, &TouchChannel::touchInteruptFn), UI_IRQ_PRIORITY);
+  exti->attach(ioIntPin, ExtiDispatcher::FALLING, callback(this, &TouchChannel::ioInteruptFn), UI_IRQ_PRIORITY);
+  pulses->combine(&gateOut, globalGateOut);
+  pulses->onEdge(&gateOut, Callback<void(uint8_t)>(this, &TouchChannel::handlePreparedEdge));
+
   for (int i = 0; i < CALIBRATION_LENGTH; i++) {                 // copy default pre-calibrated dac voltage values into class object member
     dacVoltageValues[i] = DAC_VOLTAGE_VALUES[i];
   }
@@ -73,6 +78,9 @@ void TouchChannel::initIOExpander() {
 ---------------------------------------------------------------------------- */
 // HANDLE ALL INTERUPT FLAGS
 void TouchChannel::poll() {
+  if (!events) {
+    return; // init() has not been called (or no event store was available)
+  }
   
   if (!freezeChannel) { // don't do anything if freeze enabled
     
@@ -85,8 +93,13 @@ void TouchChannel::poll() {
     }
 
     if (touchDetected) {
-      handleTouchInterupt();
+      core_util_critical_section_enter();
+      currTouch.time = touchStamp.time;
+      currTouch.tickCount = touchStamp.tickCount;
+      currTouch.tickTime = touchStamp.tickTime;
       touchDetected = false;
+      core_util_critical_section_exit();
+      handleTouchInterupt();
     }
 
 
@@ -99,14 +112,26 @@ void TouchChannel::poll() {
       handleDegreeChange();
     }
 
-    if (tickerFlag) {                                                        // every PPQN, read ADCs and update
+    releaseDueTicks();
+    uint32_t ticks = tickCount;                                              // snapshot, the clock ISR may keep ticking while we catch up
+    if (ticks != processedTicks) {
+      
+      if (ticks - processedTicks > 1) {
+        tickOverruns += ticks - processedTicks - 1;
+      }
+
+      while (processedTicks != ticks) {                                      // process every missed position in order, so no sequence events get dropped
+        advancePosition();
+        processedTicks += 1;
+        handleSequence(currPosition);                                        // HANDLE SEQUENCE (only moves the cursor along outside of the loop modes)
+      }
 
-      triggerNote(currNoteIndex, currOctave, PITCH_BEND);                    // HANDLE PITCH BEND
+      updateOutputs();                                                       // HANDLE PITCH BEND
+      prepareNextSequencedNote();
 
       if ((mode == QUANTIZE || mode == QUANTIZE_LOOP) && enableQuantizer)    // HANDLE CV QUANTIZATION
       {
         currCVInputValue = cvInput.read_u16();
-        if (gateState == HIGH) setGate(LOW);   // We only want trigger events in quantizer mode, so if the gate gets set HIGH, make sure to set it back to low the very next tick
 
         if (currCVInputValue >= prevCVInputValue + CV_QUANT_BUFFER || currCVInputValue <= prevCVInputValue - CV_QUANT_BUFFER)
         {
@@ -114,17 +139,32 @@ void TouchChannel::poll() {
           prevCVInputValue = currCVInputValue;
         }
       }
-
-      
-      if ((mode == MONO_LOOP || mode == QUANTIZE_LOOP) && enableLoop)        // HANDLE SEQUENCE
-      {
+    }
+  }
+  else {
+    releaseDueTicks();
+    uint32_t ticks = tickCount;
+    if (ticks != processedTicks) {
+      while (processedTicks != ticks) {  // keep the loop window playing while frozen, touches are ignored
+        advancePosition();
+        processedTicks += 1;
         handleSequence(currPosition);
       }
-
-      tickerFlag = false;
+      updateOutputs();
+      prepareNextSequencedNote();
     }
   }
 }
+
+/**
+ * sample the pitch bend input and output the current note and bend, once per tick (however many ticks poll() had
+ * to catch up on). Notes triggered in between use the bend sampled here, and the DacFrame drops either write when
+ * its DAC code has not changed since the last one
+*/
+void TouchChannel::updateOutputs() {
+  handlePitchBend();
+  triggerNote(currNoteIndex, currOctave, PITCH_BEND);
+}
 // ------------------------------------------------------------------------
 
 
@@ -154,11 +194,17 @@ void TouchChannel::setLoopTotalSteps() {
 }
 
 void TouchChannel::setLoopTotalPPQN() {
+  cancelPreparedNote();
   totalPPQN = totalSteps * PPQN;
+  if (windowSteps == 0) {
+    loopEnd = totalPPQN;
+  }
+  refreshNextEventPosition(); // events beyond the new loop length need to be skipped
 }
 
 void TouchChannel::enableLoopMode() {
   recordEnabled = true;
+  undoJournal.beginPass();
   if (mode == MONO) {
     setMode(MONO_LOOP);
   } else if (mode == QUANTIZE) {
@@ -189,25 +235,93 @@ void TouchChannel::disableLoopMode() {
  *         CLOCK METHODS
 ---------------------------------------------------------------------------- */
 
+/**
+ * CLOCK TICK
+ * called from the Metronome ISR. All it does is count the tick, poll() then catches up by advancing the
+ * loop position once for every tick counted - so a slow pass of the main loop never merges ticks together.
+ * The channels clockRate turns each master tick into however many channel ticks are due (ie. 4 at 4x, or 1 in every 4 at 1/4x)
+ *
+ * At multiplied rates only the first of those ticks lands on the master tick. The rest are interpolated, due
+ * tickLength apart after it, and only get counted once their time has come (see releaseDueTicks()) - so a multiplied
+ * sequence plays evenly spaced rather than bunched up at each master tick. Any left over when the next master tick
+ * arrives are counted straight away, so none ever get dropped.
+*/
+void TouchChannel::tickClock() {
+  uint32_t now = scheduler->now();
+  tickLength = ((now - lastMasterTickTime) * clockRate.denominator) / clockRate.numerator;
+  lastMasterTickTime = now;
+
+  tickCount += interpolatedTicks;
+  interpolatedTicks = 0;
+
+  int ticks = clockRate.tick();   // 0 or more channel ticks per master tick
+  if (ticks) {
+    lastTickTime = now;
+    tickCount += 1;
+    interpolatedTicks = ticks - 1;
+  }
+}
+
+/**
+ * count every interpolated tick which is now due, stamping each with the time it was due at (not when it got
+ * counted) so sub-tick offsets and prepared gate edges stay exact. Called by poll() and the touch ISR. Interpolated
+ * ticks are only as prompt as those calls, which is fine for poll() - it is the only thing which acts on the count
+*/
+void TouchChannel::releaseDueTicks() {
+  core_util_critical_section_enter();   // tickClock() gets called from the clock interrupt
+  if (interpolatedTicks > 0) {
+    uint32_t now = scheduler->now();
+    while (interpolatedTicks > 0 && (int32_t)(now - (lastTickTime + tickLength)) >= 0) {
+      lastTickTime += tickLength;
+      tickCount += 1;
+      interpolatedTicks -= 1;
+    }
+  }
+  core_util_critical_section_exit();
+}
+
+/**
+ * run the channel at a rational multiple of the master clock. Setting the rate the channel is already running at
+ * sets it back to 1x
+*/
+void TouchChannel::setClockRate(int numerator, int denominator) {
+  core_util_critical_section_enter();  // tickClock() gets called from the clock interrupt
+  if (clockRate.numerator == numerator && clockRate.denominator == denominator) {
+    clockRate.set(1, 1);
+  } else {
+    clockRate.set(numerator, denominator);
+  }
+  core_util_critical_section_exit();
+  cancelPreparedNote();  // it was timed from the old tick length
+}
+
 /**
  * ADVANCE LOOP POSITION
  * advance the channels loop position by 1 'tick', a 'tick' being a single Pulse Per Quarter Note or "PPQN"
 */
-
-void TouchChannel::tickClock() {
+void TouchChannel::advancePosition() {
   currTick += 1;
   currPosition += 1;
+  transportPosition += 1;
   
   // when currTick exceeds PPQN, reset to 0
   if (currTick >= PPQN) {
     currTick = 0;
     this->stepClock();
   }
-  if (currPosition >= totalPPQN) {
-    currPosition = 0;
-    currStep = 0;
+  if (transportPosition >= totalPPQN) {
+    transportPosition = 0;
+  }
+  if (currPosition >= loopEnd) {  // loopEnd is always step aligned, so currTick has just been reset
+    currPosition = loopStart;
+    currStep = loopStartStep;
+    if (windowSteps > 0) {
+      shrinkLoopWindow();
+    } else {
+      nextEventPosition = firstEventPosition; // reset sequence cursor to the start of the loop
+      undoJournal.beginPass();                // every time around the loop is a new (undoable) recording pass
+    }
   }
-  tickerFlag = true;
 }
 
 void TouchChannel::stepClock() {
@@ -221,8 +335,11 @@ void TouchChannel::stepClock() {
 // NOTE: you probably don't want to reset the 'tick' value, as it would make it very dificult to line up with the global clock;
 void TouchChannel::resetClock() {
   currTick = 0;
-  currPosition = 0;
-  currStep = 0;
+  currPosition = loopStart;
+  currStep = loopStartStep;
+  transportPosition = 0;
+  cancelPreparedNote();
+  updateNextEventPosition(currPosition + 1);
 }
 
 /** -------------------------------------------------------------------------------------------
@@ -231,6 +348,19 @@ void TouchChannel::resetClock() {
 
 // NOTE: you need a way to trigger events after a series of touches have happened, and the channel is now not being touched
 
+/**
+ * timestamp the touch as it happens. If an earlier touch is still waiting to be handled, its stamp is kept
+*/
+void TouchChannel::touchInteruptFn() {
+  if (!touchDetected) {
+    releaseDueTicks();
+    touchStamp.time = scheduler->now();
+    touchStamp.tickCount = tickCount;
+    touchStamp.tickTime = lastTickTime;
+    touchDetected = true;
+  }
+}
+
 void TouchChannel::handleTouchInterupt() {
   touched = touch->touched();
   if (touched != prevTouched) {
@@ -251,15 +381,27 @@ void TouchChannel::handleTouchInterupt() {
               setActiveDegrees(bitWrite(activeDegrees, i, !bitRead(activeDegrees, i)));
               break;
             case QUANTIZE_LOOP:
+            {
               // every touch detected, take a snapshot of all active degree values and apply them to a EventNode
               setActiveDegrees(bitWrite(activeDegrees, i, !bitRead(activeDegrees, i)));
-              createChordEvent(currPosition, activeDegrees);
+              int tick;
+              int position = touchPosition(&tick);
+              createChordEvent(quantizePosition(position, tick), activeDegrees);
               break;
+            }
             case MONO_LOOP:
+            {
               clearExistingNodes = true;
-              createEvent(currPosition, i, HIGH);
+              int tick;
+              int touchedAt = touchPosition(&tick);
+              int position = quantizePosition(touchedAt, tick);
+              recordOffset = timeQuantizationGrid.offsets[tick];
+              createEvent(position, i, HIGH, recordSubTick());
+              SequenceNode *node = events->find(position);
+              if (node) recordingEvent = events->ref(node);
               triggerNote(i, currOctave, ON);
               break;
+            }
           }
         }
         else { // LOOP_LENGTH_UI mode
@@ -289,18 +431,33 @@ void TouchChannel::handleTouchInterupt() {
             case QUANTIZE_LOOP:
               break;
             case MONO_LOOP:
-              createEvent(currPosition, i, LOW);
+            {
+              int position = touchPosition() + recordOffset; // keep the notes recorded length by shifting the note OFF along with its note ON
+              if (position < 0) {
+                position += totalPPQN;
+              } else if (position >= totalPPQN) {
+                position -= totalPPQN;
+              }
+              createEvent(position, i, LOW, recordSubTick());
               triggerNote(i, currOctave, OFF);
               clearExistingNodes = false;
               // create note OFF event
               // enableLoop = true;
               break;
+            }
           }
         }
       }
     }
     prevTouched = touched;
   }
+
+  uint32_t latency = scheduler->now() - currTouch.time;
+  touchStats.touches += 1;
+  touchStats.totalLatencyUs += latency;
+  if (latency > touchStats.maxLatencyUs) {
+    touchStats.maxLatencyUs = latency;
+  }
 }
 
 // -------------------------------------------------------------------------------------------
@@ -345,6 +502,7 @@ void TouchChannel::setMode(Mode targetMode) {
       enableLoop = true;
       enableQuantizer = false;
       mode = MONO_LOOP;
+      updateNextEventPosition(currPosition + 1);   // the cursor may have been left behind while out of loop mode
       setAllLeds(LOW);
       setAllLeds(DIM_LOW);
       updateOctaveLeds(currOctave);
@@ -365,6 +523,7 @@ void TouchChannel::setMode(Mode targetMode) {
       enableLoop = true;
       enableQuantizer = true;
       mode = QUANTIZE_LOOP;
+      updateNextEventPosition(currPosition + 1);   // the cursor may have been left behind while out of loop mode
       setAllLeds(LOW);
       setAllLeds(DIM_LOW);
       updateActiveDegreeLeds();
@@ -401,6 +560,7 @@ void TouchChannel::setOctave(int value) {
 }
 
 void TouchChannel::handleDegreeChange() {
+  generateNoteTables();
   switch (mode) {
     case MONO:
       triggerNote(currNoteIndex, currOctave, SUSTAIN);
@@ -539,21 +699,13 @@ void TouchChannel::updateLoopMultiplierLeds() {
 ---------------------------------------------------------------------------- */
  
 void TouchChannel::triggerNote(int index, int octave, NoteState state, bool blinkLED /* false */) {
+  if (state == ON || state == SUSTAIN || state == PREV) {
+    cancelPreparedNote();  // a note played directly takes over from a prepared one
+  }
   switch (state) {
     case ON:
-      if (mode == MONO || mode == MONO_LOOP) {
-        setLed(currNoteIndex, LOW);  // set the 'previous' active note led LOW
-        setLed(index, HIGH);         // new active note HIGH
-      }
-      if (blinkLED) setLed(index, BLINK_ON);
-      
-      prevOctave = currOctave;       // the following two lines of code used to be outside the switch block
-      prevNoteIndex = currNoteIndex;
-      currNoteIndex = index;
-      currOctave = octave;
-      setGate(HIGH);
-      setGlobalGate(HIGH);
-      dac->write(dacChannel, calculateDACNoteValue(index, octave));
+      setNote(index, octave, blinkLED);
+      gateOn();
       midi->sendNoteOn(channel, calculateMIDINoteValue(index, octave), 100);
       break;
     case SUSTAIN:
@@ -562,22 +714,22 @@ void TouchChannel::triggerNote(int index, int octave, NoteState state, bool blin
       currNoteIndex = index;
       currOctave = octave;
       setLed(index, HIGH);
-      dac->write(dacChannel, calculateDACNoteValue(index, octave));
+      writePitch(calculateDACNoteValue(index, octave));
       midi->sendNoteOn(channel, calculateMIDINoteValue(index, octave), 100);
       break;
     case OFF:
-      setGate(LOW);
-      setGlobalGate(LOW);
+      gateOff();
       midi->sendNoteOff(channel, calculateMIDINoteValue(index, octave), 100);
       // wait_us(1);
       break;
     case PREV:
       setLed(index, HIGH);
-      dac->write(dacChannel, calculateDACNoteValue(index, octave));
+      writePitch(calculateDACNoteValue(index, octave));
       midi->sendNoteOn(channel, calculateMIDINoteValue(index, octave), 100);
       break;
     case PITCH_BEND:
-      dac->write(dacChannel, calculateDACNoteValue(index, octave));
+      writePitch(calculateDACNoteValue(index, octave));
+      updatePitchBendDAC(cvOffset);
       break;
   }
 }
@@ -585,17 +737,35 @@ void TouchChannel::triggerNote(int index, int octave, NoteState state, bool blin
 
 
 
+/**
+ * make index / octave the current note, and output its pitch. Does not touch the gate
+*/
+void TouchChannel::setNote(int index, int octave, bool blinkLED /* false */) {
+  if (mode == MONO || mode == MONO_LOOP) {
+    setLed(currNoteIndex, LOW);  // set the 'previous' active note led LOW
+    setLed(index, HIGH);         // new active note HIGH
+  }
+  if (blinkLED) setLed(index, BLINK_ON);
+
+  prevOctave = currOctave;
+  prevNoteIndex = currNoteIndex;
+  currNoteIndex = index;
+  currOctave = octave;
+  writePitch(calculateDACNoteValue(index, octave));
+}
+
+/**
+ * the 1v/o DAC code for a note, including the pitch bend last sampled by updateOutputs()
+*/
 int TouchChannel::calculateDACNoteValue(int index, int octave)
 {
-  handlePitchBend();
-  updatePitchBendDAC(cvOffset);
-  return dacVoltageMap[index + DAC_OCTAVE_MAP[octave]][degrees->switchStates[index]] + (pbEnabled ? pbNoteOffset : 0);
+  return dacNoteTable[octave * DEGREE_COUNT + index] + (pbEnabled ? pbNoteOffset : 0);
 }
 
 
 
 int TouchChannel::calculateMIDINoteValue(int index, int octave) {
-  return MIDI_NOTE_MAP[index][degrees->switchStates[index]] + MIDI_OCTAVE_MAP[octave];
+  return midiNoteTable[octave * DEGREE_COUNT + index];
 }
 
 
@@ -608,6 +778,76 @@ int TouchChannel::calculateMIDINoteValue(int index, int octave) {
 */ 
 void TouchChannel::freeze(bool freeze) {
   this->freezeChannel = freeze;
+  if (freeze) {
+    enterLoopWindow();
+  } else {
+    exitLoopWindow();
+  }
+}
+
+/**
+ * FREEZE LOOP WINDOWS
+ * While frozen, playback continues over a window of the loop rather than the whole thing. The window starts as
+ * the half of the loop currently playing, and halves again every time it completes a pass (ie. 8 -> 4 -> 2 -> 1 steps).
+ * A window is only a loopStart / loopEnd pair applied by advancePosition(), no event data gets copied, and entering
+ * or leaving only costs a couple of EventStore lookups regardless of the loop length.
+*/
+void TouchChannel::enterLoopWindow() {
+  cancelPreparedNote();
+  windowSteps = totalSteps > 1 ? totalSteps / 2 : 1;
+  loopStartStep = (currStep / windowSteps) * windowSteps;  // the window the play head is currently in, so there is no jump
+  if (loopStartStep + windowSteps > totalSteps) {
+    loopStartStep = totalSteps - windowSteps;              // an odd length loop has a shorter last window, end it at the loops end instead
+  }
+  loopStart = loopStartStep * PPQN;
+  loopEnd = loopStart + windowSteps * PPQN;
+  clearExistingNodes = false;                              // touches are ignored while frozen, so nothing is being recorded
+  updateNextEventPosition(currPosition + 1);
+}
+
+// called by advancePosition() every time the window wraps
+void TouchChannel::shrinkLoopWindow() {
+  cancelPreparedNote();
+  releaseSequencedNote();
+  if (windowSteps > 1) {
+    windowSteps = windowSteps / 2;
+    loopEnd = loopStart + windowSteps * PPQN;
+  }
+  updateNextEventPosition(loopStart);
+}
+
+/**
+ * jump back to where the full loop would have been had it never been frozen, so the channel stays in phase
+*/
+void TouchChannel::exitLoopWindow() {
+  if (windowSteps == 0 || !events) return;
+  cancelPreparedNote();
+  releaseSequencedNote();
+  windowSteps = 0;
+  loopStart = 0;
+  loopStartStep = 0;
+  loopEnd = totalPPQN;
+
+  currPosition = transportPosition;
+  currStep = (transportPosition - currTick) / PPQN;        // the window is step aligned, so currTick is already correct
+
+  int i = events->lowerBound(currPosition + 1) - 1;        // the last event before the play head, as if the full loop had been playing
+  if (i < 0) {
+    i = events->lowerBound(totalPPQN) - 1;                 // wrapping around to the end of the loop
+  }
+  if (i >= 0) {
+    prevEvent = events->ref(events->nodeAt(i));
+  }
+  refreshNextEventPosition();
+}
+
+// turn off a sequenced note which is still sounding before playback jumps somewhere else in the loop
+void TouchChannel::releaseSequencedNote() {
+  if (mode != MONO_LOOP || !events) return;
+  SequenceNode *prevNode = events->resolve(prevEvent);
+  if (prevNode && prevNode->gate == HIGH) {
+    triggerNote(prevNode->noteIndex, currOctave, OFF);
+  }
 }
 
 void TouchChannel::reset() {
@@ -698,12 +938,13 @@ void TouchChannel::handlePitchBend()
     if (currPitchBend > pbZero + pbDebounce || currPitchBend < pbZero - pbDebounce) { // record pitch bend and use new value
       if (recordEnabled) {
         createPitchBendEvent(currPosition, currPitchBend);
-        setPitchBendOffset(events[currPosition].pitchBend);
       } else {
-        setPitchBendOffset(currPitchBend);
+        pitchBendLane.endRecording(currPosition);
       }
+      setPitchBendOffset(currPitchBend);
     } else {
-      setPitchBendOffset(events[currPosition].pitchBend);
+      pitchBendLane.endRecording(currPosition);  // bend has returned to idle, stop recording breakpoints
+      setPitchBendOffset(pitchBendLane.valueAt(currPosition));
     }
     
   }
@@ -738,7 +979,7 @@ void TouchChannel::setPitchBendOffset(uint16_t pitchBend)
 void TouchChannel::updatePitchBendDAC(uint16_t value)
 {
   int zero = 32767;
-  pb_dac->write(pb_dac_chan, zero + value);
+  dacBus->write(DAC_BEND, channel, zero + value);
 }
 
 /**
@@ -755,6 +996,7 @@ void TouchChannel::setPitchBendRange(int touchedIndex)
 /**
  * this function takes a 1D array and converts it into a 2D array formatted as [[0, 1, 2], ...]
  * take the first 12 values from dacVoltageValues. find the difference dacVoltageValues[i]
+ * The note tables are rebuilt from the new map.
 */
 void TouchChannel::generateDacVoltageMap()
 {
@@ -774,14 +1016,94 @@ void TouchChannel::generateDacVoltageMap()
     }
     multiplier += 1;
   }
+  generateNoteTables();
 }
 
-void TouchChannel::setGlobalGate(bool state) {
-  globalGateOut->write(state);
+/**
+ * flatten dacVoltageMap and MIDI_NOTE_MAP down to one DAC code and one MIDI note per note (octave * DEGREE_COUNT +
+ * degree), for the current degree switch positions, so playing a note is a single lookup. Rebuilt whenever the
+ * switches move or dacVoltageMap changes (calibration)
+*/
+void TouchChannel::generateNoteTables()
+{
+  for (int octave = 0; octave < OCTAVE_COUNT; octave++) {
+    for (int index = 0; index < DEGREE_COUNT; index++) {
+      int switchState = degrees->switchStates[index];
+      dacNoteTable[octave * DEGREE_COUNT + index] = dacVoltageMap[index + DAC_OCTAVE_MAP[octave]][switchState];
+      midiNoteTable[octave * DEGREE_COUNT + index] = MIDI_NOTE_MAP[index][switchState] + MIDI_OCTAVE_MAP[octave];
+    }
+  }
 }
 
+
 void TouchChannel::setGate(bool state)
 {
+  cancelPreparedNote();  // writing the gate drops every edge pending on it
   gateState = state;
-  gateOut.write(state);
+  pulses->write(&gateOut, state);
+}
+
+/**
+ * output a 1v/o DAC code, unless a prepared note is about to change it along with its gate edge
+*/
+void TouchChannel::writePitch(uint16_t code)
+{
+  if (!pitchPending) {
+    slew->setTarget(channel, code);
+  }
+}
+
+/**
+ * start of a note. In TRIGGER_MODE (and in the quantizer modes, which have no note lengths) the gate outputs
+ * pulse HIGH for triggerWidth, otherwise they are held HIGH until gateOff()
+*/
+void TouchChannel::gateOn() {
+  if (gateMode == TRIGGER_MODE || mode == QUANTIZE || mode == QUANTIZE_LOOP) {
+    if (gateState == HIGH) {
+      setGate(LOW);
+    }
+    pulses->trigger(&gateOut, triggerWidth);
+  } else {
+    setGate(HIGH);
+  }
+}
+
+/**
+ * end of a note. Triggers end on their own, so only a held gate needs setting LOW
+*/
+void TouchChannel::gateOff() {
+  if (gateState == HIGH) {
+    setGate(LOW);
+  }
+}
+
+/**
+ * same as gateOn() / gateOff(), but the gate edge gets written by the PulseGenerator at 'time'
+*/
+void TouchChannel::gateOnAt(uint32_t time, uint8_t tag /* 0 */) {
+  if (gateMode == TRIGGER_MODE) {
+    pulses->triggerAt(&gateOut, triggerWidth, time, tag);
+  } else {
+    gateState = HIGH;
+    pulses->writeAt(&gateOut, HIGH, time, tag);
+  }
+}
+
+void TouchChannel::gateOffAt(uint32_t time, uint8_t tag /* 0 */) {
+  if (gateState == HIGH) {
+    gateState = LOW;
+    pulses->writeAt(&gateOut, LOW, time, tag);
+  }
+}
+
+void TouchChannel::toggleGateMode() {
+  gateOff();
+  gateMode = gateMode == GATE_MODE ? TRIGGER_MODE : GATE_MODE;
+}
+
+/**
+ * step through the glide times in SLEW_TIMES, wrapping back round to no glide
+*/
+void TouchChannel::cycleSlewTime() {
+  slew->cycleTime(channel);
 }
\ No newline at end of file
@@ -3,8 +3,12 @@
 
 #include "main.h"
 #include "Metronome.h"
+#include "PulseGenerator.h"
+#include "ExtiDispatcher.h"
 #include "Degrees.h"
 #include "DAC8554.h"
+#include "DacBus.h"
+#include "SlewEngine.h"
 #include "CAP1208.h"
 #include "TCA9544A.h"
 #include "SX1509.h"
@@ -13,11 +17,16 @@
 #include "QuantizeMethods.h"
 #include "BitwiseMethods.h"
 #include "ArrayMethods.h"
+#include "EventStore.h"
+#include "EventStorePool.h"
+#include "UndoJournal.h"
+#include "ClockRate.h"
+#include "PitchBendLane.h"
+#include "QuantizeGrid.h"
 
 #define CHANNEL_IO_MODE_PIN 5
 #define CHANNEL_IO_TOGGLE_PIN_1 6
 #define CHANNEL_IO_TOGGLE_PIN_2 7
-#define NULL_NOTE_INDEX 99  // used to identify a 'null' or 'deleted' sequence event
 #define PB_CALIBRATION_RANGE 64
 const int PB_RANGE_MAP[8] = { 1, 2, 3, 4, 5, 7, 10, 12 };
 
@@ -34,13 +43,22 @@ typedef struct QuantOctave {
   int octave;
 } QuantOctave;
 
-typedef struct SequenceNode {
-  uint8_t activeNotes; // byte for holding active/inactive notes for a chord
-  uint8_t noteIndex;   // note index between 0 and 7
-  uint16_t pitchBend;  // raw ADC value from pitch bend
-  bool gate;           // set gate HIGH or LOW
-  bool active;         // this will tell the loop whether to trigger an event or not
-} SequenceNode;
+/**
+ * the clock state at the moment a touch interrupt fired, so the touch can be recorded where it actually happened
+ * rather than where the sequence had got to by the time poll() read the touch IC
+*/
+typedef struct TouchStamp {
+  uint32_t time;          // when the touch interrupt fired (see TimerScheduler::now())
+  uint32_t tickCount;     // the channels tickCount at that time
+  uint32_t tickTime;      // when that tick happened
+} TouchStamp;
+
+typedef struct TouchStats {
+  uint32_t touches;           // touch interrupts handled
+  uint32_t maxLatencyUs;      // worst time between a touch interrupt and it being handled (I2C read + recording)
+  uint32_t totalLatencyUs;    // divide by 'touches' for the average
+  uint32_t compensatedTicks;  // total ticks recorded events were moved back by, to where the touch happened
+} TouchStats;
 
 class TouchChannel {
   private:
@@ -81,6 +99,11 @@ class TouchChannel {
       QUANTIZE_LOOP = 3,
     };
 
+    enum GateMode {
+      GATE_MODE,      // gate stays HIGH for the length of the note
+      TRIGGER_MODE    // gate pulses HIGH for triggerWidth at the start of the note
+    };
+
     enum UIMode { // not yet implemented
       DEFAULT_UI,
       LOOP_LENGTH_UI,
@@ -89,44 +112,75 @@ class TouchChannel {
 
     int channel;                    // 0 based index to represent channel
     bool isSelected;
-    bool gateState;                 // the current state of the gate output pin
+    bool gateState;                 // true while the gate output is being held HIGH (triggers are not included)
+    GateMode gateMode;              // gate or trigger output. The quantizer modes always output triggers
+    uint32_t triggerWidth;          // (us) how long a trigger lasts
     Mode mode;                      // which mode channel is currently in
     Mode prevMode;                  // used for reverting to previous mode when toggling between UI modes
     UIMode uiMode;                  // for settings and alt LED uis
     DigitalOut gateOut;             // gate output pin
-    DigitalOut *globalGateOut;      // 
-    Timer *timer;                   // timer for handling duration based touch events
-    Ticker *ticker;                 // for handling time based callbacks
+    DigitalOut *globalGateOut;      // OR of every channels gate output, driven by the PulseGenerator
+    PulseGenerator *pulses;         // times the end of each trigger
+    TimerScheduler *scheduler;      // 64-bit microsecond timebase, for timing touch events
+    ExtiDispatcher *exti;           // routes the touch and IO interrupt pins to this channel
     MIDI *midi;                     // pointer to mbed midi instance
     CAP1208 *touch;                 // i2c touch IC
     DAC8554 *dac;                   // pointer to 1vo DAC
     DAC8554::Channels dacChannel;   // which dac to address
     DAC8554 *pb_dac;                // pointer to Pitch Bends DAC
     DAC8554::Channels pb_dac_chan;  // which dac to address
+    DacBus *dacBus;                 // 1vo and pitch bend outputs, sent all together once per main loop pass (channel n == DAC channel n)
+    SlewEngine *slew;               // glides the 1vo output to each new note
     SX1509 *io;                     // IO Expander
     AD525X *digiPot;                // digipot for pitch bend calibration
     AD525X::Channels digiPotChan;   // which channel to use for the digipot
     Degrees *degrees;
-    InterruptIn touchInterupt;
-    InterruptIn ioInterupt;         // for SC1509 3-stage toggle switch + tactile mode button
+    DigitalIn touchInterupt;
+    DigitalIn ioInterupt;           // for SC1509 3-stage toggle switch + tactile mode button
+    PinName touchIntPin;
+    PinName ioIntPin;
     AnalogIn cvInput;               // CV input pin for quantizer mode
     AnalogIn pbInput;               // CV input for Pitch Bend
 
-    volatile bool tickerFlag;        // each time the clock gets ticked, this flag gets set to true - then false in polling loop
+    volatile uint32_t tickCount;     // incremented by the clock ISR every tick, never reset
+    uint32_t processedTicks;         // number of ticks poll() has processed so far (catches up to tickCount)
+    uint32_t tickOverruns;           // number of ticks which arrived while a previous tick was still waiting to be processed
+    ClockRate clockRate;             // multiplies / divides the master clock for this channel
+    volatile uint32_t lastTickTime;  // when the most recent channel tick happened (see TimerScheduler::now())
+    uint32_t lastMasterTickTime;     // when tickClock() was last called
+    volatile uint32_t tickLength;    // (us) length of a channel tick, measured from the master clock
+    volatile int interpolatedTicks;  // channel ticks still due from the last master tick at multiplied rates, see releaseDueTicks()
     volatile bool switchHasChanged;  // toggle switches interupt flag
     volatile bool touchDetected;
+    volatile TouchStamp touchStamp;  // captured by the touch ISR
+    TouchStamp currTouch;            // the touch currently being handled
+    TouchStats touchStats;
     volatile bool modeChangeDetected;
 
     // SEQUENCER variables
-    SequenceNode events[PPQN * MAX_SEQ_STEPS];
-    QuantizeMode timeQuantizationMode;
+    typedef EventStorePool<MAX_SEQ_EVENTS, NUM_CHANNELS> SequencePool;
+    static SequencePool eventPool;                    // event stores shared (copy-on-write) between all channels
+    EventStore<MAX_SEQ_EVENTS> *events;               // sparse, position sorted note events. May be shared with other channels, see prepareEventsForWrite()
+    UndoJournal<MAX_UNDO_ENTRIES> undoJournal;        // edits made to events during each recording pass
+    PitchBendLane<MAX_PB_BREAKPOINTS> pitchBendLane;  // pitch bend automation, stored separately from note events
+    QuantizeGrid<PPQN> timeQuantizationGrid;          // record quantization, snaps touches to the selected grid
+    int recordOffset;          // how far the last recorded note ON was moved by quantization, applied to its note OFF too
+    EventRef recordingEvent;   // the note ON event currently being held / recorded
+    int preparedPosition;      // position of the sequenced note whose gate has already been scheduled, -1 if none
+    EventRef preparedEvent;    // the sequenced note whose gate has already been scheduled
+    uint32_t preparedTime;     // when the prepared notes gate edge is due
+    uint16_t preparedPitch;    // 1v/o DAC code the prepared note ON outputs along with its gate edge
+    volatile bool pitchPending; // preparedPitch is waiting on its gate edge, until then the 1v/o output is left alone
     int prevEventIndex; // index for disabling the last "triggered" event in the loop
     bool sequenceContainsEvents;
     bool clearExistingNodes;   
     bool deleteEvents;
     bool enableLoop = false;   // "Event Triggering Loop" -> This will prevent looped events from triggering if a new event is currently being created
     bool recordEnabled;        //
-    int prevNodePosition;      // represents the last node in the sequence which got triggered (either HIGH or LOW)
+    EventRef prevEvent;        // represents the last node in the sequence which got triggered (either HIGH or LOW)
+    volatile int nextEventPosition;  // position of the next event handleSequence() needs to act on (-1 when sequence is empty)
+    volatile int firstEventPosition; // position of the first event in the loop, used to reset the cursor when the loop wraps
+    uint32_t ticksSkipped;           // number of ticks handleSequence() skipped because no event was due
     volatile int numLoopSteps; // how many steps the sequence contains (before applying the multiplier)
     volatile int currStep;     // the current 'step' of the loop (lowest value == 0)
     volatile int currPosition; // the current position in the in the entire sequence (measured by PPQN)
@@ -134,6 +188,11 @@ class TouchChannel {
     int totalPPQN;             // how many PPQN the sequence currently contains (equal to totalSteps * PPQN)
     int totalSteps;            // how many Steps the sequence contains (in total ie. numLoopSteps * loopMultiplier)
     int loopMultiplier;        // number between 1 and 4 based on Octave Leds of channel
+    int loopStart;             // position playback wraps back to (0, unless a FREEZE window is active)
+    int loopStartStep;         // the step loopStart falls on
+    int loopEnd;               // position at which playback wraps back to loopStart (totalPPQN, unless a FREEZE window is active)
+    int windowSteps;           // length of the FREEZE window in steps, 0 when the full loop is playing
+    int transportPosition;     // where the full loop would be, keeps counting while a FREEZE window is active
 
     // quantizer variables
     bool quantizerHasBeenInitialized;
@@ -165,6 +224,8 @@ class TouchChannel {
     float dacSemitone = 938.0;               // must be a float, as it gets divided down to a num between 0..1
     uint16_t dacVoltageMap[32][3];
     uint16_t dacVoltageValues[CALIBRATION_LENGTH];               // pre/post calibrated 16-bit DAC values
+    uint16_t dacNoteTable[DEGREE_COUNT * OCTAVE_COUNT];          // 1v/o DAC code of every note, for the current degree switch positions
+    uint8_t midiNoteTable[DEGREE_COUNT * OCTAVE_COUNT];          // MIDI note of every note, for the current degree switch positions
 
     int redLedPins[8] = { 14, 12, 10, 8, 6, 4, 2, 0 };    // hardcoded values to be passed to the 16 chan LED driver
     int greenLedPins[8] = { 15, 13, 11, 9, 7, 5, 3, 1 };  // hardcoded values to be passed to the 16 chan LED driver
@@ -189,12 +250,13 @@ class TouchChannel {
 
     TouchChannel(
         int _channel,
-        Timer *timer_ptr,
-        Ticker *ticker_ptr,
+        TimerScheduler *scheduler_ptr,
+        ExtiDispatcher *exti_ptr,
         DigitalOut *globalGateOut_ptr,
+        PulseGenerator *pulses_ptr,
         PinName gateOutPin,
         PinName tchIntPin,
-        PinName ioIntPin,
+        PinName _ioIntPin,
         PinName cvInputPin,
         PinName pbInputPin,
         CAP1208 *touch_ptr,
@@ -205,12 +267,15 @@ class TouchChannel {
         DAC8554::Channels _dacChannel,
         DAC8554 *pb_dac_ptr,
         DAC8554::Channels pb_dac_channel,
+        DacBus *dac_bus_ptr,
+        SlewEngine *slew_ptr,
         AD525X *digiPot_ptr,
-        AD525X::Channels _digiPotChannel) : gateOut(gateOutPin), touchInterupt(tchIntPin, PullUp), ioInterupt(ioIntPin, PullUp), cvInput(cvInputPin), pbInput(pbInputPin)
+        AD525X::Channels _digiPotChannel) : gateOut(gateOutPin), touchInterupt(tchIntPin, PullUp), ioInterupt(_ioIntPin, PullUp), cvInput(cvInputPin), pbInput(pbInputPin)
     {
       globalGateOut = globalGateOut_ptr;
-      timer = timer_ptr;
-      ticker = ticker_ptr;
+      pulses = pulses_ptr;
+      scheduler = scheduler_ptr;
+      exti = exti_ptr;
       touch = touch_ptr;
       io = io_ptr;
       degrees = degrees_ptr;
@@ -218,17 +283,23 @@ class TouchChannel {
       dacChannel = _dacChannel;
       pb_dac = pb_dac_ptr;
       pb_dac_chan = pb_dac_channel;
+      dacBus = dac_bus_ptr;
+      slew = slew_ptr;
       digiPot = digiPot_ptr;
       digiPotChan = _digiPotChannel;
       midi = midi_p;
-      touchInterupt.fall(callback(this, &TouchChannel::touchInteruptFn));
-      ioInterupt.fall(callback(this, &TouchChannel::ioInteruptFn));
+      touchIntPin = tchIntPin;
+      ioIntPin = _ioIntPin;
       channel = _channel;
+      gateState = false;
+      gateMode = GATE_MODE;
+      triggerWidth = DEFAULT_TRIGGER_WIDTH;
+      events = NULL;                 // acquired from eventPool by initSequencer()
     };
 
     void init();
     void poll();
-    void touchInteruptFn() { touchDetected = true; }
+    void touchInteruptFn();
     void ioInteruptFn() { modeChangeDetected = true; }
 
     void initIOExpander();
@@ -244,6 +315,7 @@ class TouchChannel {
     void calibratePitchBend();
     void updatePitchBendDAC(uint16_t value);
     void handlePitchBend();
+    void updateOutputs();
     void setPitchBendRange(int touchedIndex);
     void setPitchBendOffset(uint16_t pitchBend);
 
@@ -253,34 +325,60 @@ class TouchChannel {
     void setMode(Mode targetMode);
     
     void tickClock();
+    void releaseDueTicks();
+    void setClockRate(int numerator, int denominator);
+    void advancePosition();
     void stepClock();
     void resetClock();
     
-    int quantizePosition(int position);
+    int quantizePosition(int position, int tick);
+    void setTimeQuantization(GridDivision division);
+    void cycleTimeQuantization();
     int calculateMIDINoteValue(int index, int octave);
     int calculateDACNoteValue(int index, int octave);
 
     void setOctave(int value);
     void triggerNote(int index, int octave, NoteState state, bool blinkLED=false);
+    void setNote(int index, int octave, bool blinkLED=false);
     void setGate(bool state);
-    void setGlobalGate(bool state);
+    void gateOn();
+    void gateOff();
+    void gateOnAt(uint32_t time, uint8_t tag=0);
+    void gateOffAt(uint32_t time, uint8_t tag=0);
+    void writePitch(uint16_t code);
+    void toggleGateMode();
+    void cycleSlewTime();
     void freeze(bool enable);
+    void enterLoopWindow();
+    void shrinkLoopWindow();
+    void exitLoopWindow();
+    void releaseSequencedNote();
     void reset();
     void generateDacVoltageMap();
+    void generateNoteTables();
 
     // UI METHODS
     void enableUIMode(UIMode target);
     void disableUIMode();
     void updateLoopLengthUI();
+    void updateQuantizeGridUI();
     void handleLoopLengthUI();
     void updatePitchBendRangeUI();
 
     // SEQUENCER METHODS
     void initSequencer();
-    void clearEvent(int position);
+    void prepareEventsForWrite();
+    int touchPosition(int *tick = NULL);
+    uint8_t recordSubTick();
+    void prepareNextSequencedNote();
+    void cancelPreparedNote();
+    void handlePreparedEdge(uint8_t tag);
+    void pasteSequence(TouchChannel *source);
+    void undoLastPass();
+    void clearEvent(int position, bool undoable=true);
     void clearEventSequence();
     void clearPitchBendSequence();
-    void createEvent(int position, int noteIndex, bool gate);
+    void createEvent(int position, int noteIndex, bool gate, uint8_t offset=0);
     void createChordEvent(int position, uint8_t notes);
     void createPitchBendEvent(int position, uint16_t pitchBend);
     void clearLoop(); // refractor into clearEventSequence()
@@ -291,6 +389,8 @@ class TouchChannel {
     void setLoopTotalPPQN();  // refractor into metronom class
     void setLoopTotalSteps(); // refractor into metronom class
     void handleSequence(int position);
+    void updateNextEventPosition(int position);
+    void refreshNextEventPosition();
 
     // QUANTIZER METHODS
     void initQuantizerMode();
@@ -49,6 +49,28 @@ void TouchChannel::updateLoopLengthUI()
             setLed(i, HIGH, true);
         }
     }
+    updateQuantizeGridUI();
+}
+
+/**
+ * Display the record quantization grid as a single dimmed LED (1/4 == LED 1 ... 1/32T == LED 7)
+ * the LED gets lit even if it falls outside the loop length. No dimmed LED means quantization is off
+*/
+void TouchChannel::updateQuantizeGridUI()
+{
+    for (int i = 0; i < 8; i++)
+    {
+        setLed(i, DIM_HIGH, true);
+    }
+    if (timeQuantizationGrid.division != GRID_NONE)
+    {
+        int led = timeQuantizationGrid.division - 1;
+        setLed(led, DIM_LOW, true);
+        if (led >= numLoopSteps)
+        {
+            setLed(led, HIGH, true);
+        }
+    }
 }
 
 void TouchChannel::handleLoopLengthUI()
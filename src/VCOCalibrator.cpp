@@ -36,12 +36,13 @@ void VCOCalibrator::enableCalibrationMode()
     channel->setOctaveLed(0, TouchChannel::LOW);
     channel->dac->write(channel->dacChannel, channel->dacVoltageValues[0]); // start at bottom most note.
 
-    ticker.attach_us(callback(this, &VCOCalibrator::sampleVCOFrequency), VCO_SAMPLE_RATE_US);
+    scheduler->attach(TimerScheduler::CALIBRATION, callback(this, &VCOCalibrator::sampleVCOFrequency), VCO_SAMPLE_RATE_US);
 }
 
 void VCOCalibrator::disableCalibrationMode()
 {
-    ticker.detach();  // disable ticker
+    scheduler->detach(TimerScheduler::CALIBRATION);  // stop sampling
+    channel->dacBus->invalidate(DAC_PITCH, channel->channel); // the DAC was written directly, make sure the next note gets sent
     channel->setAllLeds(TouchChannel::HIGH);
     wait_us(500000);
     channel->setAllLeds(TouchChannel::LOW);
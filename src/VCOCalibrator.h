@@ -3,6 +3,7 @@
 
 #include "main.h"
 #include "TouchChannel.h"
+#include "TimerScheduler.h"
 
 const float VCO_SAMPLE_RATE_HZ = 1 / VCO_SAMPLE_RATE_US * 1000000; // may need to cast all these values to floats
 
@@ -11,7 +12,7 @@ public:
 
     VCOCalibrator(){};
     
-    Ticker ticker;                                // for sampling frequence at a given sample rate
+    TimerScheduler *scheduler;                    // CALIBRATION channel samples the frequency at a given sample rate
     TouchChannel *channel;                        // pointer to channel to be calibrated
 
     int currVCOInputVal;                          // the current sampled value of sinewave input
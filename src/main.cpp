@@ -1,11 +1,17 @@
 #include "main.h"
 #include "Metronome.h"
+#include "TimerScheduler.h"
+#include "ExtiDispatcher.h"
+#include "SyncPort.h"
+#include "PulseGenerator.h"
 #include "TouchChannel.h"
 #include "GlobalControl.h"
 #include "Degrees.h"
 #include "CAP1208.h"
 #include "MIDI.h"
 #include "DAC8554.h"
+#include "DacBus.h"
+#include "SlewEngine.h"
 #include "TCA9548A.h"
 #include "MCP23017.h"
 #include "AD525X.h"
@@ -21,14 +27,17 @@ I2C i2c1(I2C1_SDA, I2C1_SCL);
 I2C i2c3(I2C3_SDA, I2C3_SCL);
 
 DigitalOut globalGate(GLOBAL_GATE_OUT);
-Ticker ticker;
-Timer timer;
+TimerScheduler scheduler;
+PulseGenerator pulses(&scheduler);
 MIDI midi(MIDI_TX, MIDI_RX);
-InterruptIn extClockInput(EXT_CLOCK_INPUT);
+ExtiDispatcher exti;
+DigitalIn extClockInput(EXT_CLOCK_INPUT);
 
 AD525X digiPot(&i2c1);
 DAC8554 dac1(SPI2_MOSI, SPI2_SCK, DAC1_CS);
 DAC8554 dac2(SPI2_MOSI, SPI2_SCK, DAC2_CS);
+DacBus dacBus(SPI2_MOSI, SPI2_SCK, DAC1_CS, DAC2_CS);
+SlewEngine slew(&dacBus);
 MCP23017 io(&i2c3, MCP23017_DEGREES_ADDR);
 
 SX1509 ioA(&i2c3, SX1509_CHAN_A_ADDR);
@@ -47,42 +56,25 @@ CAP1208 touchOctCD(&i2c1, &i2cMux, TCA9548A::CH5);
 CAP1208 touchCTRL1(&i2c1, &i2cMux, TCA9548A::CH6);
 CAP1208 touchCTRL2(&i2c1, &i2cMux, TCA9548A::CH7);
 
-Degrees degrees(DEGREES_INT, &io);
+Degrees degrees(DEGREES_INT, &exti, &io);
 
-TouchChannel channelA(0, &timer, &ticker, &globalGate, GATE_OUT_A, TOUCH_INT_A, IO_INT_PIN_A, ADC_A, PB_ADC_A, &touchA, &ioA, &degrees, &midi, &dac1, DAC8554::CHAN_A, &dac2, DAC8554::CHAN_A, &digiPot, AD525X::CHAN_A);
-TouchChannel channelB(1, &timer, &ticker, &globalGate, GATE_OUT_B, TOUCH_INT_B, IO_INT_PIN_B, ADC_B, PB_ADC_B, &touchB, &ioB, &degrees, &midi, &dac1, DAC8554::CHAN_B, &dac2, DAC8554::CHAN_B, &digiPot, AD525X::CHAN_B);
-TouchChannel channelC(2, &timer, &ticker, &globalGate, GATE_OUT_C, TOUCH_INT_C, IO_INT_PIN_C, ADC_C, PB_ADC_C, &touchC, &ioC, &degrees, &midi, &dac1, DAC8554::CHAN_C, &dac2, DAC8554::CHAN_C, &digiPot, AD525X::CHAN_C);
-TouchChannel channelD(3, &timer, &ticker, &globalGate, GATE_OUT_D, TOUCH_INT_D, IO_INT_PIN_D, ADC_D, PB_ADC_D, &touchD, &ioD, &degrees, &midi, &dac1, DAC8554::CHAN_D, &dac2, DAC8554::CHAN_D, &digiPot, AD525X::CHAN_D);
+TouchChannel channelA(0, &scheduler, &exti, &globalGate, &pulses, GATE_OUT_A, TOUCH_INT_A, IO_INT_PIN_A, ADC_A, PB_ADC_A, &touchA, &ioA, &degrees, &midi, &dac1, DAC8554::CHAN_A, &dac2, DAC8554::CHAN_A, &dacBus, &slew, &digiPot, AD525X::CHAN_A);
+TouchChannel channelB(1, &scheduler, &exti, &globalGate, &pulses, GATE_OUT_B, TOUCH_INT_B, IO_INT_PIN_B, ADC_B, PB_ADC_B, &touchB, &ioB, &degrees, &midi, &dac1, DAC8554::CHAN_B, &dac2, DAC8554::CHAN_B, &dacBus, &slew, &digiPot, AD525X::CHAN_B);
+TouchChannel channelC(2, &scheduler, &exti, &globalGate, &pulses, GATE_OUT_C, TOUCH_INT_C, IO_INT_PIN_C, ADC_C, PB_ADC_C, &touchC, &ioC, &degrees, &midi, &dac1, DAC8554::CHAN_C, &dac2, DAC8554::CHAN_C, &dacBus, &slew, &digiPot, AD525X::CHAN_C);
+TouchChannel channelD(3, &scheduler, &exti, &globalGate, &pulses, GATE_OUT_D, TOUCH_INT_D, IO_INT_PIN_D, ADC_D, PB_ADC_D, &touchD, &ioD, &degrees, &midi, &dac1, DAC8554::CHAN_D, &dac2, DAC8554::CHAN_D, &dacBus, &slew, &digiPot, AD525X::CHAN_D);
 
-Metronome metronome(TEMPO_LED, TEMPO_POT, INT_CLOCK_OUTPUT, PPQN, DEFAULT_CHANNEL_LOOP_STEPS);
+Metronome metronome(TEMPO_LED, TEMPO_POT, INT_CLOCK_OUTPUT, DEFAULT_CHANNEL_LOOP_STEPS, &scheduler, &pulses);
 
-GlobalControl globalCTRL(&metronome, &touchCTRL1, &touchCTRL2, &touchOctAB, &touchOctCD, TOUCH_INT_CTRL_1, TOUCH_INT_CTRL_2, TOUCH_INT_OCT_AB, TOUCH_INT_OCT_CD, REC_LED, &channelA, &channelB, &channelC, &channelD);
-
-int newClockTimeStamp;
-int lastClockTimeStamp;
-int clockPeriod;
+SyncPort sync(SYNC_TX, SYNC_RX, &scheduler, &metronome);
 
+GlobalControl globalCTRL(&metronome, &exti, &sync, &touchCTRL1, &touchCTRL2, &touchOctAB, &touchOctCD, TOUCH_INT_CTRL_1, TOUCH_INT_CTRL_2, TOUCH_INT_OCT_AB, TOUCH_INT_OCT_CD, REC_LED, &channelA, &channelB, &channelC, &channelD);
 
+/**
+ * EXTERNAL CLOCK INPUT
+ * quarter note pulses, the metronomes clock follower generates the PPQN ticks in between
+*/
 void extTick() {
-  // you need to advance every quarter note when an external clock signal is detected
-  // additionally, set the ticker timer to a division of the input pulse duration / PPQN
-  // the ticker will handle precise timing between quarter notes, and this interupt will advance each channels step
-
-  // lastClockTimeStamp = newClockTimeStamp;
-  // newClockTimeStamp = timer.read_us();
-  // clockPeriod = newClockTimeStamp - lastClockTimeStamp;
-
-  // channelA.stepClock();
-  // channelB.stepClock();
-  // channelC.stepClock();
-  // channelD.stepClock();
-
-  // channelA.tickClock();
-  // channelB.tickClock();
-  // channelC.tickClock();
-  // channelD.tickClock();
-
-  // ticker.attach_us(&tick, clockPeriod / PPQN);  // potentially write this as a flag and update in main loop
+  metronome.handleExternalClock();
 }
 
 
@@ -90,7 +82,11 @@ int main() {
   i2c1.frequency(400000);
   i2c3.frequency(400000);
   
-  timer.start();
+  scheduler.init();
+  exti.init();
+  dacBus.init();
+  slew.init();
+  exti.measureLatency(EXT_CLOCK_INPUT, EXT_CLOCK_IRQ_PRIORITY);
 
   degrees.init();
 
@@ -102,11 +98,15 @@ int main() {
   globalCTRL.init();
   globalCTRL.loadCalibrationDataFromFlash();
 
-  extClockInput.rise(&extTick);
+  sync.init();
+
+  exti.attach(EXT_CLOCK_INPUT, ExtiDispatcher::RISING, callback(extTick), EXT_CLOCK_IRQ_PRIORITY);
 
   while(1) {
 
     if (globalCTRL.mode == GlobalControl::CALIBRATING) {
+      slew.paused = true;
+      while (dacBus.isBusy()) {}    // the calibrator writes its DAC through the blocking driver
       if (globalCTRL.calibrator.calibrationFinished == false) {
         globalCTRL.calibrator.calibrateVCO();
       } else {
@@ -114,6 +114,7 @@ int main() {
         globalCTRL.mode = GlobalControl::DEFAULT;
       }
     } else {
+      slew.paused = false;
       metronome.poll();
       globalCTRL.poll();
       degrees.poll();
@@ -121,6 +122,7 @@ int main() {
       channelB.poll();
       channelC.poll();
       channelD.poll();
+      dacBus.flush();               // every DAC output changed during this pass updates at once
     }
     
     
@@ -4,12 +4,19 @@
 #include <mbed.h>
 #include <arm_math.h> // ARM DSP functions
 
-#define PPQN                 96
+#ifndef PPQN
+#define PPQN                 96   // sequencer and clock resolution (ticks per quarter note). Pick 24, 48, 96 or 192 with a build flag
+#endif
+static_assert(PPQN == 24 || PPQN == 48 || PPQN == 96 || PPQN == 192, "PPQN must be 24, 48, 96 or 192");
 
 #define MIDI_BAUD            31250
 #define MIDI_TX              PA_2
 #define MIDI_RX              PA_3
 
+#define SYNC_BAUD            115200
+#define SYNC_TX              PC_12  // UART5, to the next units SYNC_RX
+#define SYNC_RX              PD_2   // UART5, from the previous units SYNC_TX
+
 #define I2C3_SDA             PC_9
 #define I2C3_SCL             PA_8
 #define I2C1_SDA             PB_9
@@ -56,6 +63,9 @@
 
 #define DAC1_CS              PB_12
 #define DAC2_CS              PC_8
+#define DAC_SPI_FREQUENCY    20000000
+#define DAC_PITCH            0      // DacFrame chip index of dac1, the 1v/o outputs
+#define DAC_BEND             1      // DacFrame chip index of dac2, the pitch bend outputs
 
 #define TCA9548A_ADDR            0x70 // 1110000
 #define CAP1208_ADDR             0x50 // 0010100  via mux
@@ -80,8 +90,29 @@
 #define DEFAULT_CHANNEL_LOOP_STEPS     8
 #define EVENT_END_BUFFER               4
 #define CV_QUANT_BUFFER                1000
-#define SLEW_CV_BUFFER                 1000
 #define MAX_SEQ_STEPS                 32
+#define MAX_SEQ_EVENTS               256    // max number of note events a single channel sequence can hold
+#define MAX_PB_BREAKPOINTS           128    // max number of pitch bend breakpoints a single channel sequence can hold
+#define MAX_UNDO_ENTRIES             128    // max number of event edits a channel can undo
+#define NUM_CHANNELS                   4
+
+#define TIMER_SCHEDULER_IRQ_PRIORITY   0    // NVIC priority of the TIM2 scheduler and the external clock input (0 == highest)
+#define EXT_CLOCK_IRQ_PRIORITY         TIMER_SCHEDULER_IRQ_PRIORITY // the external clock input never pre-empts (or gets pre-empted by) the scheduler
+#define UI_IRQ_PRIORITY                2    // NVIC priority of the touch / IO expander interrupts, pre-empted by the clock
+#define NUM_EXTI_LINES                16
+#define EXTI_LATENCY_SAMPLES          16    // software triggered edges timed by ExtiDispatcher::measureLatency()
+#define SYNC_TIMEOUT             3000000    // (us) a follower which hears nothing for this long goes back to being the master
+#define SYNC_TX_BUFFER_SIZE           64    // bytes queued for sending over the sync link, must be a power of 2
+#define DAC_QUEUE_SIZE                16    // DAC writes which can wait for the SPI bus, must be a power of 2
+#define DAC_DMA_IRQ_PRIORITY           3    // NVIC priority of the DAC SPI DMA, below the clock and UI interrupts
+#define SLEW_UPDATE_RATE            2000    // (Hz) how often gliding 1v/o outputs take a step
+#define SLEW_IRQ_PRIORITY              3    // NVIC priority of the TIM7 slew update, below the clock and UI interrupts
+#define NUM_SLEW_TIMES                 4
+#define MAX_PULSE_OUTPUTS              5    // gate A-D and the clock output (the global gate is combined from gate A-D)
+#define MAX_PULSE_EDGES                4    // max number of edges which can be pending on a single output
+#define PREPARED_NOTE_EDGE             1    // PulseGenerator tag of the gate edges scheduled by TouchChannel::prepareNextSequencedNote()
+#define DEFAULT_TRIGGER_WIDTH       5000    // (us) how long a gate output stays HIGH when triggered
+#define CLOCK_PULSE_WIDTH           5000    // (us) how long the clock output stays HIGH on every step
 
 #define DEFAULT_VOLTAGE_ADJMNT      200
 #define MAX_CALIB_ATTEMPTS          20
@@ -157,6 +188,9 @@ const int MIDI_NOTE_MAP[8][3] = {
 const int DAC_OCTAVE_MAP[4] = { 0, 8, 16, 24 };
 const int MIDI_OCTAVE_MAP[4] = { 36, 48, 60, 72 };
 
+// (us) glide time constants cycled through by the SLEW_CH_* gestures, 0 == no glide
+const uint32_t SLEW_TIMES[NUM_SLEW_TIMES] = { 0, 15000, 60000, 250000 };
+
 #define CALIBRATION_LENGTH   64
 
 const int CALIBRATION_LED_MAP[CALIBRATION_LENGTH] = {
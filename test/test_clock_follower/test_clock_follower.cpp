@@ -0,0 +1,131 @@
+#include <unity.h>
+#include <iostream>
+#include <stdlib.h>
+#include <vector>
+#include "ClockFollower.h"
+
+using namespace std;
+
+#define PPQN 96
+
+ClockFollower follower(PPQN, 2000, 2000000);
+vector<uint32_t> ticks;  // timestamp of every tick emitted
+
+void setUp(void) {
+  follower.reset();
+  ticks.clear();
+}
+
+void tearDown(void) {
+  // clean stuff up here
+}
+
+void emit(int count, uint32_t now) {
+  for (int i = 0; i < count; i++) ticks.push_back(now);
+}
+
+// run the follower up until 'end', the same way the timer interrupt would
+void runUntil(uint32_t end) {
+  while (follower.timerArmed && (int32_t)(follower.nextEventTime - end) <= 0) {
+    uint32_t now = follower.nextEventTime;
+    emit(follower.expire(now), now);
+  }
+}
+
+void edge(uint32_t now) {
+  runUntil(now);
+  emit(follower.edge(now), now);
+}
+
+void test_steady_clock() {
+  uint32_t period = 500000; // 120 bpm
+  for (int i = 0; i <= 8; i++) {
+    edge(i * period);
+  }
+  TEST_ASSERT_EQUAL(7 * PPQN + 1, ticks.size()); // the first edge only starts the measurement
+  TEST_ASSERT_EQUAL(0, follower.catchUpTicks);
+  // ticks are evenly spaced
+  for (size_t i = 1; i < ticks.size(); i++) {
+    TEST_ASSERT_INT_WITHIN(1, (int)(period / PPQN), (int)(ticks[i] - ticks[i - 1]));
+  }
+}
+
+void test_jittery_clock() {
+  uint32_t period = 250000;
+  uint32_t now = 0;
+  srand(1);
+  int beats = 400;
+  for (int i = 0; i <= beats; i++) {
+    edge(now + (rand() % 401) - 200);   // +/- 200us of jitter on each edge
+    now += period;
+  }
+  TEST_ASSERT_EQUAL((beats - 1) * PPQN + 1, ticks.size());  // never a duplicate or skipped tick
+
+  int worstInterpolated = 0;  // between the ticks generated by the follower
+  int worstDownbeat = 0;      // between the last tick of a beat and the next edge (inherits the input jitter)
+  for (size_t i = PPQN * 10; i < ticks.size(); i++) {
+    int error = abs((int)(ticks[i] - ticks[i - 1]) - (int)(period / PPQN));
+    if (i % PPQN == 0) {
+      if (error > worstDownbeat) worstDownbeat = error;
+    } else {
+      if (error > worstInterpolated) worstInterpolated = error;
+    }
+  }
+  cout << "filtered period: " << follower.period << "us  worst interpolated tick error: " << worstInterpolated << "us  worst downbeat error: " << worstDownbeat << "us  catch up ticks: " << follower.catchUpTicks << endl;
+  TEST_ASSERT_INT_WITHIN(200, (int)period, (int)follower.period);
+  TEST_ASSERT_LESS_THAN(5, worstInterpolated);
+}
+
+void test_tempo_increase_never_skips() {
+  for (int i = 0; i <= 4; i++) edge(i * 500000);
+  uint32_t now = 4 * 500000;
+  for (int i = 1; i <= 4; i++) edge(now + i * 250000);  // suddenly twice as fast
+  TEST_ASSERT_EQUAL(7 * PPQN + 1, ticks.size());
+  TEST_ASSERT_EQUAL(250000, follower.period);
+}
+
+void test_tempo_decrease_never_duplicates() {
+  for (int i = 0; i <= 4; i++) edge(i * 250000);
+  uint32_t now = 4 * 250000;
+  for (int i = 1; i <= 4; i++) edge(now + i * 400000);  // slower
+  TEST_ASSERT_EQUAL(7 * PPQN + 1, ticks.size());
+  TEST_ASSERT_EQUAL(400000, follower.period);
+}
+
+void test_holds_tempo_on_dropout() {
+  uint32_t period = 500000;
+  for (int i = 0; i <= 4; i++) edge(i * period);
+  runUntil(4 * period + 10 * period);        // clock stops for 10 beats
+  TEST_ASSERT_TRUE(follower.holding);
+  TEST_ASSERT_EQUAL(1, follower.dropouts);
+  size_t count = ticks.size();
+  TEST_ASSERT_INT_WITHIN(PPQN, 13 * PPQN + 1, (int)count);
+
+  uint32_t now = 4 * period + 10 * period + 123456;
+  edge(now);                                 // clock comes back
+  TEST_ASSERT_FALSE(follower.holding);
+  TEST_ASSERT_EQUAL(0, (ticks.size() - 1) % PPQN); // still a whole number of beats
+  edge(now + period);
+  edge(now + period * 2);
+  TEST_ASSERT_EQUAL(period, follower.period);
+}
+
+void test_ignores_bounce() {
+  edge(0);
+  edge(500);
+  edge(500000);
+  TEST_ASSERT_EQUAL(500000, follower.period);
+}
+
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_steady_clock);
+    RUN_TEST(test_jittery_clock);
+    RUN_TEST(test_tempo_increase_never_skips);
+    RUN_TEST(test_tempo_decrease_never_duplicates);
+    RUN_TEST(test_holds_tempo_on_dropout);
+    RUN_TEST(test_ignores_bounce);
+    UNITY_END();
+    return 0;
+}
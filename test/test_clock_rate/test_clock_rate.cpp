@@ -0,0 +1,73 @@
+#include <unity.h>
+#include <iostream>
+#include "ClockRate.h"
+
+using namespace std;
+
+#define PPQN 96
+
+ClockRate rate;
+
+void setUp(void) {
+  rate.set(1, 1);
+}
+
+void tearDown(void) {
+  // clean stuff up here
+}
+
+uint32_t run(uint32_t masterTicks) {
+  uint32_t ticks = 0;
+  for (uint32_t i = 0; i < masterTicks; i++) {
+    ticks += rate.tick();
+  }
+  return ticks;
+}
+
+void test_unity_rate() {
+  TEST_ASSERT_EQUAL(PPQN, run(PPQN));
+}
+
+void test_multiply() {
+  rate.set(4, 1);
+  TEST_ASSERT_EQUAL(4, rate.tick());
+  TEST_ASSERT_EQUAL(4 * PPQN - 4, run(PPQN - 1));
+}
+
+void test_divide() {
+  rate.set(1, 4);
+  TEST_ASSERT_EQUAL(0, rate.tick());
+  TEST_ASSERT_EQUAL(0, rate.tick());
+  TEST_ASSERT_EQUAL(0, rate.tick());
+  TEST_ASSERT_EQUAL(1, rate.tick());  // every 4th master tick
+}
+
+void test_odd_ratio() {
+  rate.set(3, 2);
+  TEST_ASSERT_EQUAL(1, rate.tick());
+  TEST_ASSERT_EQUAL(2, rate.tick());
+  TEST_ASSERT_EQUAL(3, run(2));
+}
+
+// after any whole number of master bars, a scaled channel has advanced by exactly rate * bars
+void test_phase_locked_over_long_runs() {
+  uint32_t masterTicks = PPQN * 200 * 60;     // an hour at 200 bpm
+  uint8_t rates[5][2] = { { 1, 4 }, { 1, 2 }, { 2, 1 }, { 4, 1 }, { 3, 4 } };
+  for (int i = 0; i < 5; i++) {
+    rate.set(rates[i][0], rates[i][1]);
+    TEST_ASSERT_EQUAL((uint64_t)masterTicks * rates[i][0] / rates[i][1], run(masterTicks));
+    TEST_ASSERT_EQUAL(0, rate.phase);
+  }
+}
+
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_unity_rate);
+    RUN_TEST(test_multiply);
+    RUN_TEST(test_divide);
+    RUN_TEST(test_odd_ratio);
+    RUN_TEST(test_phase_locked_over_long_runs);
+    UNITY_END();
+    return 0;
+}
@@ -0,0 +1,104 @@
+#include <unity.h>
+#include "DacFrame.h"
+
+void setUp(void) {
+  // set stuff up here
+}
+
+void tearDown(void) {
+  // clean stuff up here
+}
+
+void test_command_word() {
+  TEST_ASSERT_EQUAL_HEX32(0x001234, DacFrame::command(DacFrame::STORE, 0, 0x1234));
+  TEST_ASSERT_EQUAL_HEX32(0x06FFFF, DacFrame::command(DacFrame::STORE, 3, 0xFFFF));
+  TEST_ASSERT_EQUAL_HEX32(0x228000, DacFrame::command(DacFrame::LOAD_ALL, 1, 0x8000));
+}
+
+void test_empty_frame_sends_nothing() {
+  DacFrame frame;
+  DacCommand commands[DAC_FRAME_MAX_COMMANDS];
+  TEST_ASSERT_FALSE(frame.isDirty());
+  TEST_ASSERT_EQUAL(0, frame.flush(commands));
+}
+
+// every output of one chip stored, the last store loads all four at once
+void test_single_chip_loads_with_last_write() {
+  DacFrame frame;
+  DacCommand commands[DAC_FRAME_MAX_COMMANDS];
+  frame.write(0, 0, 100);
+  frame.write(0, 2, 200);
+  frame.write(0, 3, 300);
+
+  TEST_ASSERT_EQUAL(3, frame.flush(commands));
+  TEST_ASSERT_EQUAL(1, commands[0].chips);
+  TEST_ASSERT_EQUAL_HEX32(DacFrame::command(DacFrame::STORE, 0, 100), commands[0].word);
+  TEST_ASSERT_EQUAL_HEX32(DacFrame::command(DacFrame::STORE, 2, 200), commands[1].word);
+  TEST_ASSERT_EQUAL_HEX32(DacFrame::command(DacFrame::LOAD_ALL, 3, 300), commands[2].word);
+  TEST_ASSERT_FALSE(frame.isDirty());
+}
+
+// outputs on both chips are only stored, then loaded together by a broadcast to both chips
+void test_both_chips_load_with_broadcast() {
+  DacFrame frame;
+  DacCommand commands[DAC_FRAME_MAX_COMMANDS];
+  for (int chan = 0; chan < DAC_FRAME_CHANNELS; chan++) {
+    frame.write(0, chan, chan);
+    frame.write(1, chan, 32767 + chan);
+  }
+
+  TEST_ASSERT_EQUAL(DAC_FRAME_MAX_COMMANDS, frame.flush(commands));
+  for (int i = 0; i < DAC_FRAME_MAX_COMMANDS - 1; i++) {
+    TEST_ASSERT_EQUAL(DacFrame::STORE, (commands[i].word >> 16) & 0x30);
+    TEST_ASSERT_EQUAL(i < DAC_FRAME_CHANNELS ? 1 : 2, commands[i].chips);
+  }
+  TEST_ASSERT_EQUAL(3, commands[DAC_FRAME_MAX_COMMANDS - 1].chips);
+  TEST_ASSERT_EQUAL_HEX32(0x300000, commands[DAC_FRAME_MAX_COMMANDS - 1].word);
+}
+
+// an output written many times in one pass is only sent once, with its last value
+void test_repeated_writes_coalesce() {
+  DacFrame frame;
+  DacCommand commands[DAC_FRAME_MAX_COMMANDS];
+  for (int i = 0; i < 50; i++) {
+    frame.write(1, 2, i);
+  }
+  TEST_ASSERT_EQUAL(1, frame.flush(commands));
+  TEST_ASSERT_EQUAL_HEX32(DacFrame::command(DacFrame::LOAD_ALL, 2, 49), commands[0].word);
+  TEST_ASSERT_EQUAL(50, frame.writes);
+  TEST_ASSERT_EQUAL(1, frame.transactions);
+}
+
+// rewriting an output with the value it already holds sends nothing, until it gets invalidated
+void test_unchanged_writes_are_dropped() {
+  DacFrame frame;
+  DacCommand commands[DAC_FRAME_MAX_COMMANDS];
+  TEST_ASSERT_TRUE(frame.write(0, 1, 1000));           // never written, always sent
+  TEST_ASSERT_EQUAL(1, frame.flush(commands));
+
+  for (int tick = 0; tick < 10; tick++) {
+    TEST_ASSERT_FALSE(frame.write(0, 1, 1000));
+    TEST_ASSERT_EQUAL(0, frame.flush(commands));
+  }
+  TEST_ASSERT_EQUAL(10, frame.writesAvoided);
+
+  TEST_ASSERT_TRUE(frame.write(0, 1, 1001));
+  TEST_ASSERT_TRUE(frame.write(0, 1, 1000));           // back to the old value before the flush, still has to go
+  TEST_ASSERT_EQUAL(1, frame.flush(commands));
+
+  frame.invalidate(0, 1);
+  TEST_ASSERT_TRUE(frame.write(0, 1, 1000));
+  TEST_ASSERT_EQUAL(10, frame.writesAvoided);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_command_word);
+  RUN_TEST(test_empty_frame_sends_nothing);
+  RUN_TEST(test_single_chip_loads_with_last_write);
+  RUN_TEST(test_both_chips_load_with_broadcast);
+  RUN_TEST(test_repeated_writes_coalesce);
+  RUN_TEST(test_unchanged_writes_are_dropped);
+  UNITY_END();
+  return 0;
+}
@@ -0,0 +1,223 @@
+#include <unity.h>
+#include <iostream>
+#include <chrono>
+#include "EventStore.h"
+
+using namespace std;
+
+#define PPQN           96
+#define MAX_SEQ_STEPS  32
+#define MAX_SEQ_EVENTS 256
+#define TOTAL_PPQN     (PPQN * MAX_SEQ_STEPS)
+
+void setUp(void) {
+  // set stuff up here
+}
+
+void tearDown(void) {
+  // clean stuff up here
+}
+
+// the old way of storing a sequence, one node for every PPQN position in the loop
+typedef struct DenseNode {
+  uint8_t activeNotes;
+  uint8_t noteIndex;
+  uint16_t pitchBend;
+  bool gate;
+  bool active;
+} DenseNode;
+
+DenseNode denseEvents[TOTAL_PPQN];
+EventStore<MAX_SEQ_EVENTS> store;
+
+void test_insert_keeps_positions_sorted() {
+  store.clear();
+  store.insert(300)->noteIndex = 3;
+  store.insert(12)->noteIndex = 1;
+  store.insert(3000)->noteIndex = 4;
+  store.insert(96)->noteIndex = 2;
+
+  TEST_ASSERT_EQUAL(4, store.size());
+  TEST_ASSERT_EQUAL(12, store.positionAt(0));
+  TEST_ASSERT_EQUAL(96, store.positionAt(1));
+  TEST_ASSERT_EQUAL(300, store.positionAt(2));
+  TEST_ASSERT_EQUAL(3000, store.positionAt(3));
+  TEST_ASSERT_EQUAL(2, store.nodeAt(1)->noteIndex);
+}
+
+void test_insert_existing_position_returns_same_node() {
+  store.clear();
+  SequenceNode *node = store.insert(48);
+  node->noteIndex = 5;
+  TEST_ASSERT_TRUE(node == store.insert(48));
+  TEST_ASSERT_EQUAL(1, store.size());
+  TEST_ASSERT_EQUAL(5, store.find(48)->noteIndex);
+}
+
+void test_find_missing_position() {
+  store.clear();
+  store.insert(10);
+  store.insert(20);
+  TEST_ASSERT_NULL(store.find(0));
+  TEST_ASSERT_NULL(store.find(15));
+  TEST_ASSERT_NULL(store.find(21));
+  TEST_ASSERT_NOT_NULL(store.find(20));
+}
+
+void test_remove_recycles_slot() {
+  store.clear();
+  SequenceNode *a = store.insert(10);
+  store.insert(20);
+  store.insert(30);
+
+  TEST_ASSERT_TRUE(store.remove(10));
+  TEST_ASSERT_FALSE(store.remove(10));
+  TEST_ASSERT_EQUAL(2, store.size());
+  TEST_ASSERT_EQUAL(20, store.positionAt(0));
+
+  SequenceNode *b = store.insert(5); // should re-use the slot freed by position 10
+  TEST_ASSERT_TRUE(a == b);
+  TEST_ASSERT_EQUAL(5, store.positionAt(0));
+}
+
+void test_pointers_stay_valid_after_insert() {
+  store.clear();
+  SequenceNode *node = store.insert(500);
+  node->noteIndex = 7;
+  for (int i = 0; i < 100; i++) {
+    store.insert(i);  // shifts the index, but never the pool
+  }
+  TEST_ASSERT_TRUE(node == store.find(500));
+  TEST_ASSERT_EQUAL(7, node->noteIndex);
+}
+
+void test_full_store_rejects_new_events() {
+  store.clear();
+  for (int i = 0; i < MAX_SEQ_EVENTS; i++) {
+    TEST_ASSERT_NOT_NULL(store.insert(i * 2));
+  }
+  TEST_ASSERT_TRUE(store.isFull());
+  TEST_ASSERT_NULL(store.insert(1));
+  TEST_ASSERT_NOT_NULL(store.insert(2)); // existing positions can still be written to
+}
+
+void test_clear() {
+  store.clear();
+  store.insert(1);
+  store.insert(2);
+  store.clear();
+  TEST_ASSERT_TRUE(store.isEmpty());
+  TEST_ASSERT_NULL(store.find(1));
+}
+
+void test_clear_invalidates_references() {
+  store.clear();
+  SequenceNode *node = store.insert(24);
+  EventRef ref = store.ref(node);
+  TEST_ASSERT_TRUE(store.resolve(ref) == node);
+
+  store.clear();
+  TEST_ASSERT_NULL(store.resolve(ref));
+
+  store.insert(48); // slot gets recycled by a new event
+  TEST_ASSERT_NULL(store.resolve(ref));
+}
+
+void test_remove_invalidates_references() {
+  store.clear();
+  EventRef ref = store.ref(store.insert(24));
+  store.remove(24);
+  TEST_ASSERT_NULL(store.resolve(ref));
+
+  store.insert(24); // same slot, same position, but a new event
+  TEST_ASSERT_NULL(store.resolve(ref));
+}
+
+void test_memory_footprint() {
+  cout << "dense events[]: " << sizeof(denseEvents) << " bytes per channel" << endl;
+  cout << "EventStore<" << MAX_SEQ_EVENTS << ">: " << sizeof(store) << " bytes per channel" << endl;
+  TEST_ASSERT_TRUE(sizeof(store) * 4 < sizeof(denseEvents));
+}
+
+/**
+ * BENCHMARK
+ * walk the entire loop one tick at a time (the same way handleSequence() gets called) and
+ * compare the cost of looking up the event at each position
+*/
+int benchmarkDense(int passes) {
+  int hits = 0;
+  for (int pass = 0; pass < passes; pass++) {
+    for (int position = 0; position < TOTAL_PPQN; position++) {
+      if (denseEvents[position].active) {
+        hits += denseEvents[position].noteIndex;
+      }
+    }
+  }
+  return hits;
+}
+
+int benchmarkSparse(int passes) {
+  int hits = 0;
+  for (int pass = 0; pass < passes; pass++) {
+    for (int position = 0; position < TOTAL_PPQN; position++) {
+      SequenceNode *node = store.find(position);
+      if (node) {
+        hits += node->noteIndex;
+      }
+    }
+  }
+  return hits;
+}
+
+void fillSequences(int numEvents) {
+  store.clear();
+  for (int i = 0; i < TOTAL_PPQN; i++) {
+    denseEvents[i].active = false;
+  }
+  for (int i = 0; i < numEvents; i++) {
+    int position = (i * TOTAL_PPQN) / numEvents;
+    denseEvents[position].active = true;
+    denseEvents[position].noteIndex = i % 8;
+    store.insert(position)->noteIndex = i % 8;
+  }
+}
+
+void test_benchmark_lookup_per_tick() {
+  int eventCounts[4] = { 3, 32, 128, MAX_SEQ_EVENTS };
+  int passes = 200;
+
+  for (int i = 0; i < 4; i++) {
+    fillSequences(eventCounts[i]);
+
+    auto start = chrono::steady_clock::now();
+    int denseHits = benchmarkDense(passes);
+    auto end = chrono::steady_clock::now();
+    double denseNs = chrono::duration<double, nano>(end - start).count() / (passes * TOTAL_PPQN);
+
+    start = chrono::steady_clock::now();
+    int sparseHits = benchmarkSparse(passes);
+    end = chrono::steady_clock::now();
+    double sparseNs = chrono::duration<double, nano>(end - start).count() / (passes * TOTAL_PPQN);
+
+    cout << "events: " << eventCounts[i] << " dense: " << denseNs << " ns/tick  sparse: " << sparseNs << " ns/tick" << endl;
+    TEST_ASSERT_EQUAL(denseHits, sparseHits);
+  }
+}
+
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_insert_keeps_positions_sorted);
+    RUN_TEST(test_insert_existing_position_returns_same_node);
+    RUN_TEST(test_find_missing_position);
+    RUN_TEST(test_remove_recycles_slot);
+    RUN_TEST(test_pointers_stay_valid_after_insert);
+    RUN_TEST(test_full_store_rejects_new_events);
+    RUN_TEST(test_clear);
+    RUN_TEST(test_clear_invalidates_references);
+    RUN_TEST(test_remove_invalidates_references);
+    RUN_TEST(test_memory_footprint);
+    RUN_TEST(test_benchmark_lookup_per_tick);
+    UNITY_END();
+    return 0;
+}
@@ -0,0 +1,109 @@
+#include <unity.h>
+#include <iostream>
+#include "EventStorePool.h"
+
+using namespace std;
+
+#define MAX_SEQ_EVENTS 256
+#define NUM_CHANNELS   4
+
+typedef EventStorePool<MAX_SEQ_EVENTS, NUM_CHANNELS> Pool;
+
+Pool *pool;
+Pool::Store *channels[NUM_CHANNELS];
+
+void setUp(void) {
+  pool = new Pool();
+  for (int i = 0; i < NUM_CHANNELS; i++) {
+    channels[i] = pool->acquire();
+  }
+}
+
+void tearDown(void) {
+  delete pool;
+}
+
+void paste(int from, int to) {
+  pool->retain(channels[from]);
+  pool->release(channels[to]);
+  channels[to] = channels[from];
+}
+
+void test_every_channel_gets_a_store() {
+  TEST_ASSERT_EQUAL(0, pool->numFree());
+  TEST_ASSERT_NULL(pool->acquire());
+}
+
+void test_paste_shares_store() {
+  channels[0]->insert(10)->noteIndex = 3;
+  paste(0, 1);
+
+  TEST_ASSERT_TRUE(channels[0] == channels[1]);
+  TEST_ASSERT_TRUE(pool->isShared(channels[0]));
+  TEST_ASSERT_EQUAL(1, pool->numFree());  // the destinations old store went back to the pool
+  TEST_ASSERT_EQUAL(3, channels[1]->find(10)->noteIndex);
+}
+
+void test_write_duplicates_shared_store() {
+  channels[0]->insert(10)->noteIndex = 3;
+  SequenceNode *node = channels[0]->find(10);
+  EventRef ref = channels[0]->ref(node);
+  paste(0, 1);
+
+  channels[1] = pool->makeWritable(channels[1]);
+  channels[1]->insert(20)->noteIndex = 5;
+  channels[1]->remove(10);
+
+  TEST_ASSERT_FALSE(channels[0] == channels[1]);
+  TEST_ASSERT_FALSE(pool->isShared(channels[0]));
+  TEST_ASSERT_EQUAL(1, channels[0]->size());     // the original is untouched
+  TEST_ASSERT_NULL(channels[0]->find(20));
+  TEST_ASSERT_TRUE(channels[0]->resolve(ref) == node);
+  TEST_ASSERT_EQUAL(1, channels[1]->size());
+  TEST_ASSERT_EQUAL(5, channels[1]->find(20)->noteIndex);
+}
+
+void test_copy_keeps_references_valid() {
+  channels[0]->insert(10);
+  channels[0]->insert(20);
+  EventRef ref = channels[0]->ref(channels[0]->find(20));
+  paste(0, 1);
+
+  channels[1] = pool->makeWritable(channels[1]);
+  SequenceNode *copied = channels[1]->resolve(ref);
+  TEST_ASSERT_TRUE(copied == channels[1]->find(20));
+}
+
+void test_writing_unshared_store_does_not_copy() {
+  Pool::Store *store = channels[2];
+  TEST_ASSERT_TRUE(pool->makeWritable(store) == store);
+}
+
+void test_all_channels_sharing_one_store() {
+  channels[0]->insert(96);
+  paste(0, 1);
+  paste(0, 2);
+  paste(0, 3);
+  TEST_ASSERT_EQUAL(3, pool->numFree());
+  TEST_ASSERT_EQUAL(4, pool->refCount(channels[0]));
+
+  for (int i = 1; i < NUM_CHANNELS; i++) {  // every channel diverges, there is always a free store to copy into
+    channels[i] = pool->makeWritable(channels[i]);
+    TEST_ASSERT_NOT_NULL(channels[i]);
+    TEST_ASSERT_NOT_NULL(channels[i]->find(96));
+  }
+  TEST_ASSERT_EQUAL(0, pool->numFree());
+}
+
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_every_channel_gets_a_store);
+    RUN_TEST(test_paste_shares_store);
+    RUN_TEST(test_write_duplicates_shared_store);
+    RUN_TEST(test_copy_keeps_references_valid);
+    RUN_TEST(test_writing_unshared_store_does_not_copy);
+    RUN_TEST(test_all_channels_sharing_one_store);
+    UNITY_END();
+    return 0;
+}
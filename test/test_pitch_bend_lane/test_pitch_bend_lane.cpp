@@ -0,0 +1,102 @@
+#include <unity.h>
+#include <iostream>
+#include "PitchBendLane.h"
+
+using namespace std;
+
+#define PB_ZERO     30000
+#define PB_DEBOUNCE 200
+
+PitchBendLane<128> lane;
+
+void setUp(void) {
+  lane.clear(PB_ZERO);
+}
+
+void tearDown(void) {
+  // clean stuff up here
+}
+
+void printLane() {
+  for (int i = 0; i < lane.size(); i++) {
+    cout << "position: " << lane.points[i].position << " value: " << lane.points[i].value << endl;
+  }
+}
+
+void test_empty_lane_returns_idle_value() {
+  TEST_ASSERT_EQUAL(PB_ZERO, lane.valueAt(0));
+  TEST_ASSERT_EQUAL(PB_ZERO, lane.valueAt(500));
+}
+
+void test_held_bend_only_stores_movements() {
+  // bend up to 35000 over 10 ticks, then hold it for 300 ticks
+  for (int pos = 10; pos < 20; pos++) {
+    lane.record(pos, PB_ZERO + (pos - 9) * 500, PB_DEBOUNCE);
+  }
+  for (int pos = 20; pos < 320; pos++) {
+    lane.record(pos, 35000, PB_DEBOUNCE);
+  }
+  lane.endRecording(320);
+  printLane();
+
+  TEST_ASSERT_LESS_THAN(16, lane.size());
+  TEST_ASSERT_EQUAL(PB_ZERO, lane.valueAt(5));
+  TEST_ASSERT_EQUAL(35000, lane.valueAt(200));
+  TEST_ASSERT_EQUAL(35000, lane.valueAt(319));
+  TEST_ASSERT_EQUAL(PB_ZERO, lane.valueAt(320));
+  TEST_ASSERT_EQUAL(PB_ZERO, lane.valueAt(1000));
+}
+
+void test_interpolates_between_breakpoints() {
+  lane.record(0, 40000, PB_DEBOUNCE);
+  lane.record(100, 30000, PB_DEBOUNCE);
+  lane.endRecording(100);
+
+  TEST_ASSERT_EQUAL(40000, lane.valueAt(0));
+  TEST_ASSERT_INT_WITHIN(1, 35000, lane.valueAt(50));
+  TEST_ASSERT_INT_WITHIN(1, 32500, lane.valueAt(75));
+}
+
+void test_overdub_replaces_existing_bend() {
+  lane.record(10, 40000, PB_DEBOUNCE);
+  lane.record(50, 40000, PB_DEBOUNCE);
+  lane.endRecording(51);
+
+  lane.record(20, 25000, PB_DEBOUNCE);
+  for (int pos = 21; pos <= 40; pos++) {
+    lane.record(pos, 25000, PB_DEBOUNCE);
+  }
+  lane.endRecording(41);
+  printLane();
+
+  TEST_ASSERT_EQUAL(40000, lane.valueAt(10));
+  TEST_ASSERT_EQUAL(40000, lane.valueAt(19));   // existing bend is held until the overdub starts
+  TEST_ASSERT_EQUAL(25000, lane.valueAt(30));
+  TEST_ASSERT_EQUAL(40000, lane.valueAt(45));   // and resumes once it ends
+  TEST_ASSERT_EQUAL(PB_ZERO, lane.valueAt(51));
+}
+
+void test_recording_across_loop_wrap() {
+  lane.record(380, 38000, PB_DEBOUNCE);
+  lane.record(383, 38000, PB_DEBOUNCE);
+  lane.record(0, 38000, PB_DEBOUNCE);   // loop wrapped
+  lane.record(5, 38000, PB_DEBOUNCE);
+  lane.endRecording(6);
+  printLane();
+
+  TEST_ASSERT_EQUAL(38000, lane.valueAt(2));
+  TEST_ASSERT_EQUAL(38000, lane.valueAt(381));
+  TEST_ASSERT_EQUAL(PB_ZERO, lane.valueAt(100));
+}
+
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_empty_lane_returns_idle_value);
+    RUN_TEST(test_held_bend_only_stores_movements);
+    RUN_TEST(test_interpolates_between_breakpoints);
+    RUN_TEST(test_overdub_replaces_existing_bend);
+    RUN_TEST(test_recording_across_loop_wrap);
+    UNITY_END();
+    return 0;
+}
@@ -0,0 +1,58 @@
+#include <unity.h>
+#include <stdlib.h>
+#include "PotFilter.h"
+
+PotFilter<2> filter(800);
+
+void setUp(void) {
+  filter.primed = false;
+}
+
+void tearDown(void) {
+  // clean stuff up here
+}
+
+void test_first_reading_is_reported() {
+  TEST_ASSERT_TRUE(filter.update(30000));
+  TEST_ASSERT_EQUAL(30000, filter.output);
+}
+
+void test_noise_is_ignored() {
+  filter.update(30000);
+  srand(1);
+  for (int i = 0; i < 1000; i++) {
+    uint16_t noise = rand() % 1500;
+    TEST_ASSERT_FALSE(filter.update(30000 - 750 + noise));
+  }
+  TEST_ASSERT_EQUAL(30000, filter.output);
+}
+
+void test_follows_a_move() {
+  filter.update(10000);
+  int changes = 0;
+  for (int i = 0; i < 50; i++) {
+    changes += filter.update(50000);
+  }
+  TEST_ASSERT_TRUE(changes > 0);
+  TEST_ASSERT_INT_WITHIN(800, 50000, (int)filter.output);
+}
+
+void test_single_spike_is_smoothed() {
+  filter.update(10000);
+  filter.update(14000);                       // one bad reading only moves the filter a quarter of the way
+  TEST_ASSERT_INT_WITHIN(800, 11000, (int)filter.output);
+  for (int i = 0; i < 20; i++) {
+    filter.update(10000);
+  }
+  TEST_ASSERT_INT_WITHIN(800, 10000, (int)filter.output);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_first_reading_is_reported);
+  RUN_TEST(test_noise_is_ignored);
+  RUN_TEST(test_follows_a_move);
+  RUN_TEST(test_single_spike_is_smoothed);
+  UNITY_END();
+  return 0;
+}
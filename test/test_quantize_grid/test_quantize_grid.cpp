@@ -0,0 +1,92 @@
+#include <unity.h>
+#include <iostream>
+#include <stdlib.h>
+#include "QuantizeGrid.h"
+
+using namespace std;
+
+#define PPQN       96
+#define NUM_STEPS  8
+#define TOTAL_PPQN (PPQN * NUM_STEPS)
+
+QuantizeGrid<PPQN> grid;
+
+void setUp(void) {
+  grid.setDivision(GRID_NONE);
+}
+
+void tearDown(void) {
+  // clean stuff up here
+}
+
+int snap(int position) {
+  return grid.snap(position, position % PPQN, TOTAL_PPQN);
+}
+
+void test_no_quantization() {
+  for (int position = 0; position < TOTAL_PPQN; position++) {
+    TEST_ASSERT_EQUAL(position, snap(position));
+  }
+}
+
+void test_quantize_16th() {
+  grid.setDivision(GRID_16);
+  TEST_ASSERT_EQUAL(96, snap(88));
+  TEST_ASSERT_EQUAL(96, snap(107));
+  TEST_ASSERT_EQUAL(120, snap(108));  // exactly half way rounds up
+  TEST_ASSERT_EQUAL(0, snap(TOTAL_PPQN - 5)); // wraps around the end of the loop
+}
+
+void test_quantize_triplets() {
+  grid.setDivision(GRID_8T);   // 32 PPQN apart
+  TEST_ASSERT_EQUAL(32, snap(40));
+  TEST_ASSERT_EQUAL(64, snap(50));
+  grid.setDivision(GRID_32T);  // 8 PPQN apart
+  TEST_ASSERT_EQUAL(200, snap(203));
+}
+
+// the lookup table should always agree with snapping the position the slow way
+void test_table_matches_divide() {
+  for (int division = GRID_4; division < NUM_GRID_DIVISIONS; division++) {
+    grid.setDivision((GridDivision)division);
+    int interval = PPQN / GRID_NOTES_PER_STEP[division];
+    for (int position = 0; position < TOTAL_PPQN; position++) {
+      int expected = ((position + interval / 2) / interval) * interval;
+      if (expected >= TOTAL_PPQN) expected -= TOTAL_PPQN;
+      TEST_ASSERT_EQUAL(expected, snap(position));
+    }
+  }
+}
+
+// every selectable resolution should have every grid line land on a whole tick
+template <int TICKS_PER_STEP>
+void checkResolution() {
+  QuantizeGrid<TICKS_PER_STEP> other;
+  int total = TICKS_PER_STEP * NUM_STEPS;
+  for (int division = GRID_4; division < NUM_GRID_DIVISIONS; division++) {
+    other.setDivision((GridDivision)division);
+    int interval = TICKS_PER_STEP / GRID_NOTES_PER_STEP[division];
+    for (int position = 0; position < total; position++) {
+      int snapped = other.snap(position, position % TICKS_PER_STEP, total);
+      TEST_ASSERT_EQUAL(0, snapped % interval);
+      TEST_ASSERT_TRUE(abs(snapped - position) <= interval / 2 || abs(snapped - position) >= total - interval / 2);
+    }
+  }
+}
+
+void test_other_resolutions() {
+  checkResolution<24>();
+  checkResolution<48>();
+  checkResolution<192>();
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_no_quantization);
+    RUN_TEST(test_quantize_16th);
+    RUN_TEST(test_quantize_triplets);
+    RUN_TEST(test_table_matches_divide);
+    RUN_TEST(test_other_resolutions);
+    UNITY_END();
+    return 0;
+}
@@ -0,0 +1,119 @@
+#include <unity.h>
+#include "Slew.h"
+
+#define RATE 2000
+
+void setUp(void) {
+  // set stuff up here
+}
+
+void tearDown(void) {
+  // clean stuff up here
+}
+
+// count updates until the output reaches 'code', giving up after 'limit'
+int glide(Slew &slew, uint16_t code, int limit) {
+  slew.setTarget(code);
+  int updates = 0;
+  while (slew.isGliding() && updates < limit) {
+    slew.update();
+    updates += 1;
+  }
+  return updates;
+}
+
+void test_disabled_by_default() {
+  Slew slew;
+  TEST_ASSERT_FALSE(slew.isEnabled());
+  slew.setTimeConstant(0, RATE);
+  TEST_ASSERT_EQUAL(SLEW_Q16_ONE, slew.coefficient);
+  TEST_ASSERT_FALSE(slew.isEnabled());
+
+  slew.setTarget(40000);
+  TEST_ASSERT_EQUAL(40000, slew.update());
+  TEST_ASSERT_FALSE(slew.isGliding());
+}
+
+void test_jump_skips_the_glide() {
+  Slew slew;
+  slew.setTimeConstant(100000, RATE);
+  slew.jump(1234);
+  TEST_ASSERT_FALSE(slew.isGliding());
+  TEST_ASSERT_EQUAL(1234, slew.output());
+}
+
+// after one time constant the output has covered 63% of the distance, after three 95%
+void test_time_constant() {
+  Slew slew;
+  slew.setTimeConstant(50000, RATE);   // 100 updates
+  slew.jump(0);
+  slew.setTarget(60000);
+  uint16_t code = 0;
+  for (int i = 0; i < 100; i++) code = slew.update();
+  TEST_ASSERT_UINT_WITHIN(200, 37927, code);
+  for (int i = 0; i < 200; i++) code = slew.update();
+  TEST_ASSERT_UINT_WITHIN(200, 57013, code);
+}
+
+// both directions move monotonically and land exactly on the target, without overshooting
+void test_lands_on_target_without_overshoot() {
+  Slew slew;
+  slew.setTimeConstant(20000, RATE);
+  slew.jump(100);
+
+  slew.setTarget(65535);
+  uint16_t last = 100;
+  while (slew.isGliding()) {
+    uint16_t code = slew.update();
+    TEST_ASSERT_TRUE(code >= last);
+    TEST_ASSERT_TRUE(code <= 65535);
+    last = code;
+  }
+  TEST_ASSERT_EQUAL(65535, slew.output());
+
+  slew.setTarget(0);
+  while (slew.isGliding()) {
+    uint16_t code = slew.update();
+    TEST_ASSERT_TRUE(code <= last);
+    last = code;
+  }
+  TEST_ASSERT_EQUAL(0, slew.output());
+}
+
+// the fractional part keeps very slow glides moving, even when they cover well under one code per update
+void test_slow_glide_does_not_stall() {
+  Slew slew;
+  slew.setTimeConstant(2000000, RATE);
+  TEST_ASSERT_TRUE(slew.coefficient > 0);
+  slew.jump(1000);
+  int updates = glide(slew, 1100, 100000);
+  TEST_ASSERT_FALSE(slew.isGliding());
+  TEST_ASSERT_EQUAL(1100, slew.output());
+  TEST_ASSERT_TRUE(updates > 4000);    // ~ tau * ln(100) = 9200
+}
+
+// a new target part way through carries on from wherever the output had got to
+void test_retarget_mid_glide() {
+  Slew slew;
+  slew.setTimeConstant(50000, RATE);
+  slew.jump(10000);
+  slew.setTarget(50000);
+  uint16_t code = 0;
+  for (int i = 0; i < 50; i++) code = slew.update();
+  slew.setTarget(20000);
+  uint16_t next = slew.update();
+  TEST_ASSERT_TRUE(next < code);
+  TEST_ASSERT_TRUE(next > 20000);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_disabled_by_default);
+  RUN_TEST(test_jump_skips_the_glide);
+  RUN_TEST(test_time_constant);
+  RUN_TEST(test_lands_on_target_without_overshoot);
+  RUN_TEST(test_slow_glide_does_not_stall);
+  RUN_TEST(test_retarget_mid_glide);
+  UNITY_END();
+  return 0;
+}
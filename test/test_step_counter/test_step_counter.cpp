@@ -0,0 +1,85 @@
+#include <unity.h>
+#include "StepCounter.h"
+#include "ClockFollower.h"
+
+#define PPQN 96
+#define NUM_STEPS 8
+
+void setUp(void) {
+  // set stuff up here
+}
+
+void tearDown(void) {
+  // clean stuff up here
+}
+
+void test_counts_steps_and_loops() {
+  StepCounter counter(PPQN, NUM_STEPS);
+  int downbeats = 0;
+  for (int i = 0; i < PPQN * NUM_STEPS; i++) {
+    bool downbeat = counter.tick();
+    TEST_ASSERT_EQUAL(i % PPQN == 0, downbeat);
+    if (downbeat) downbeats += 1;
+    TEST_ASSERT_EQUAL((counter.currStep - 1) * PPQN + counter.currTick, counter.position);
+  }
+  TEST_ASSERT_EQUAL(NUM_STEPS, downbeats);
+  TEST_ASSERT_EQUAL(1, counter.currStep);     // back round to the start of the loop
+  TEST_ASSERT_EQUAL(1, counter.currTick);
+  TEST_ASSERT_EQUAL(1, counter.position);
+}
+
+void test_set_position() {
+  StepCounter counter(PPQN, NUM_STEPS);
+  counter.setPosition(3, 2);
+  TEST_ASSERT_EQUAL(2 * PPQN + 2, counter.position);
+  TEST_ASSERT_FALSE(counter.tick());
+}
+
+// the internal clock is part way through a step when an external clock locks, the same sequence as
+// Metronome::handleClockEdge. The locking edge has to play the downbeat of a step, and so does every edge after it
+void test_external_clock_locks_on_a_downbeat() {
+  StepCounter counter(PPQN, NUM_STEPS);
+  ClockFollower follower(PPQN, 2000, 2000000);
+  follower.reset();
+  bool externalClock = false;
+
+  for (int i = 0; i < PPQN + 40; i++) {         // internal clock, stopping 40 ticks into step 2
+    counter.tick();
+  }
+  TEST_ASSERT_EQUAL(2, counter.currStep);
+  TEST_ASSERT_EQUAL(41, counter.currTick);
+
+  uint32_t period = 500000;
+  int lockedEdges = 0;
+  for (int i = 0; i <= 4; i++) {
+    uint32_t now = i * period;
+    while (follower.timerArmed && (int32_t)(follower.nextEventTime - now) <= 0) {
+      if (follower.expire(follower.nextEventTime)) {
+        counter.tick();
+      }
+    }
+    int ticks = follower.edge(now);
+    if (follower.locked && !externalClock) {
+      externalClock = true;
+      counter.alignToDownbeat();
+    }
+    if (ticks > 0) {
+      TEST_ASSERT_EQUAL(1, counter.currTick);
+      TEST_ASSERT_EQUAL((counter.currStep - 1) * PPQN + 1, counter.position);
+      TEST_ASSERT_TRUE(counter.tick());
+      for (int t = 1; t < ticks; t++) counter.tick();
+      lockedEdges += 1;
+    }
+  }
+  TEST_ASSERT_TRUE(externalClock);
+  TEST_ASSERT_TRUE(lockedEdges >= 3);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_counts_steps_and_loops);
+  RUN_TEST(test_set_position);
+  RUN_TEST(test_external_clock_locks_on_a_downbeat);
+  UNITY_END();
+  return 0;
+}
@@ -0,0 +1,231 @@
+#include <unity.h>
+#include <iostream>
+#include <pty.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include "SyncLink.h"
+#include "ClockFollower.h"
+
+using namespace std;
+
+#define PPQN 96
+#define BAUD 115200
+
+void setUp(void) {
+  // set stuff up here
+}
+
+void tearDown(void) {
+  // clean stuff up here
+}
+
+SyncFrame makeFrame(uint8_t type, uint8_t seq, uint8_t step) {
+  SyncFrame frame;
+  frame.type = type;
+  frame.seq = seq;
+  frame.hops = 0;
+  frame.step = step;
+  frame.numSteps = 8;
+  frame.bpm = 120;
+  return frame;
+}
+
+// feed a buffer to the decoder, returning the number of frames it completed
+int feed(SyncDecoder &decoder, const uint8_t *bytes, int length) {
+  int frames = 0;
+  for (int i = 0; i < length; i++) {
+    if (decoder.receive(bytes[i])) frames += 1;
+  }
+  return frames;
+}
+
+void test_encode_decode() {
+  uint8_t bytes[SYNC_FRAME_LENGTH];
+  SyncFrame frame = makeFrame(SYNC_BEAT, 7, 3);
+  frame.hops = 2;
+  TEST_ASSERT_EQUAL(SYNC_FRAME_LENGTH, SyncLink::encode(frame, bytes));
+
+  SyncDecoder decoder;
+  TEST_ASSERT_EQUAL(1, feed(decoder, bytes, SYNC_FRAME_LENGTH));
+  TEST_ASSERT_EQUAL(SYNC_BEAT, decoder.frame.type);
+  TEST_ASSERT_EQUAL(7, decoder.frame.seq);
+  TEST_ASSERT_EQUAL(2, decoder.frame.hops);
+  TEST_ASSERT_EQUAL(3, decoder.frame.step);
+  TEST_ASSERT_EQUAL(8, decoder.frame.numSteps);
+  TEST_ASSERT_EQUAL(120, decoder.frame.bpm);
+}
+
+void test_corrupt_frame_is_dropped() {
+  uint8_t bytes[SYNC_FRAME_LENGTH * 2];
+  SyncLink::encode(makeFrame(SYNC_BEAT, 0, 1), bytes);
+  SyncLink::encode(makeFrame(SYNC_BEAT, 1, 2), bytes + SYNC_FRAME_LENGTH);
+  bytes[4] ^= 0x10;
+
+  SyncDecoder decoder;
+  TEST_ASSERT_EQUAL(1, feed(decoder, bytes, sizeof(bytes)));
+  TEST_ASSERT_EQUAL(1, decoder.errors);
+  TEST_ASSERT_EQUAL(2, decoder.frame.step);
+}
+
+// line noise, including false start bytes, ahead of a good frame
+void test_resync_after_noise() {
+  uint8_t bytes[5 + SYNC_FRAME_LENGTH] = { 0x00, SYNC_START_BYTE, 0x13, SYNC_START_BYTE, 0xFF };
+  SyncLink::encode(makeFrame(SYNC_RESET, 0, 5), bytes + 5);
+
+  SyncDecoder decoder;
+  TEST_ASSERT_EQUAL(1, feed(decoder, bytes, sizeof(bytes)));
+  TEST_ASSERT_EQUAL(SYNC_RESET, decoder.frame.type);
+  TEST_ASSERT_EQUAL(5, decoder.frame.step);
+}
+
+void test_lost_frames_are_counted() {
+  uint8_t bytes[SYNC_FRAME_LENGTH];
+  SyncDecoder decoder;
+  int seqs[4] = { 10, 11, 14, 15 };
+  for (int i = 0; i < 4; i++) {
+    SyncLink::encode(makeFrame(SYNC_BEAT, seqs[i], 1), bytes);
+    feed(decoder, bytes, SYNC_FRAME_LENGTH);
+  }
+  TEST_ASSERT_EQUAL(4, decoder.frames);
+  TEST_ASSERT_EQUAL(2, decoder.lost);
+}
+
+/**
+ * one end of a pseudo serial port, standing in for a UART
+*/
+struct Pipe {
+  int writeFd;
+  int readFd;
+
+  Pipe() {
+    openpty(&writeFd, &readFd, NULL, NULL, NULL);
+    struct termios raw;
+    tcgetattr(readFd, &raw);
+    cfmakeraw(&raw);
+    tcsetattr(readFd, TCSANOW, &raw);
+    fcntl(readFd, F_SETFL, O_NONBLOCK);
+  }
+
+  ~Pipe() {
+    close(writeFd);
+    close(readFd);
+  }
+
+  void send(const SyncFrame &frame) {
+    uint8_t bytes[SYNC_FRAME_LENGTH];
+    SyncLink::encode(frame, bytes);
+    TEST_ASSERT_EQUAL(SYNC_FRAME_LENGTH, write(writeFd, bytes, SYNC_FRAME_LENGTH));
+  }
+};
+
+/**
+ * a follower unit, doing what SyncPort + Metronome do with every frame: relay it, follow the beat with the edge time
+ * compensated for the time the frame spent on the wire, and snap to the masters step
+*/
+struct Follower {
+  Pipe *in;
+  Pipe *out;                  // NULL for the last unit in the chain
+  int depth;                  // how many links away from the master
+  SyncDecoder decoder;
+  ClockFollower clock;
+  int step;
+
+  Follower(Pipe *_in, Pipe *_out, int _depth) : clock(PPQN, 10000, 2000000) {
+    in = _in;
+    out = _out;
+    depth = _depth;
+    step = 0;
+  }
+
+  // read whatever has arrived. 'sentAt' is when the master sent the frame, the wire delay gets added on here
+  int receive(uint32_t sentAt) {
+    uint8_t byte;
+    int frames = 0;
+    int idle = 0;
+    while (idle < 1000) {
+      if (read(in->readFd, &byte, 1) != 1) {
+        idle += 1;
+        usleep(10);
+        continue;
+      }
+      idle = 0;
+      if (!decoder.receive(byte)) continue;
+
+      frames += 1;
+      SyncFrame frame = decoder.frame;
+      frame.hops += 1;
+      if (out) out->send(frame);
+
+      uint32_t now = sentAt + SyncLink::frameTimeUs(BAUD) * depth;  // when the last byte would have arrived
+      uint32_t edgeTime = now - SyncLink::frameTimeUs(BAUD) * frame.hops;
+      if (clock.edge(edgeTime) > 0) {
+        step = frame.step;
+      }
+    }
+    return frames;
+  }
+};
+
+/**
+ * a master and two chained followers. Noise is injected into the first link every few beats. Both followers end
+ * up with the masters exact period, beats landing at the exact time the master played them, and the masters step
+*/
+void test_followers_phase_lock_over_pty() {
+  Pipe link1, link2;
+  Follower first(&link1, &link2, 1);
+  Follower second(&link2, NULL, 2);
+
+  uint32_t period = 500000;   // 120bpm
+  uint32_t beatTime = 1000;
+  int numSteps = 4;
+  uint8_t noise[3] = { SYNC_START_BYTE, 0x42, 0x00 };
+
+  for (int beat = 0; beat < 32; beat++) {
+    int step = (beat % numSteps) + 1;
+    SyncFrame frame = makeFrame(SYNC_BEAT, beat, step);
+    frame.numSteps = numSteps;
+    link1.send(frame);
+    if (beat % 5 == 3) {
+      write(link1.writeFd, noise, sizeof(noise));
+    }
+
+    first.receive(beatTime);
+    second.receive(beatTime);
+
+    if (beat > 1) {
+      TEST_ASSERT_TRUE(first.clock.locked);
+      TEST_ASSERT_TRUE(second.clock.locked);
+      TEST_ASSERT_EQUAL(period, first.clock.period);
+      TEST_ASSERT_EQUAL(period, second.clock.period);
+      TEST_ASSERT_EQUAL(beatTime, first.clock.lastEdge);
+      TEST_ASSERT_EQUAL(beatTime, second.clock.lastEdge);
+      TEST_ASSERT_EQUAL(step, first.step);
+      TEST_ASSERT_EQUAL(step, second.step);
+    }
+
+    // play out the rest of the beat, as the CLOCK_FOLLOWER channel would
+    while (first.clock.timerArmed && first.clock.ticksThisBeat < PPQN) first.clock.expire(first.clock.nextEventTime);
+    while (second.clock.timerArmed && second.clock.ticksThisBeat < PPQN) second.clock.expire(second.clock.nextEventTime);
+
+    beatTime += period;
+  }
+
+  cout << "relayed frames: " << second.decoder.frames << ", noise errors on the first link: " << first.decoder.errors << endl;
+  TEST_ASSERT_EQUAL(0, second.decoder.errors);
+  TEST_ASSERT_EQUAL(0, first.decoder.lost);
+  TEST_ASSERT_EQUAL(32, second.decoder.frames);
+  TEST_ASSERT_EQUAL(first.clock.ticksEmitted, second.clock.ticksEmitted);
+  TEST_ASSERT_EQUAL(31 * PPQN, first.clock.ticksEmitted);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_encode_decode);
+  RUN_TEST(test_corrupt_frame_is_dropped);
+  RUN_TEST(test_resync_after_noise);
+  RUN_TEST(test_lost_frames_are_counted);
+  RUN_TEST(test_followers_phase_lock_over_pty);
+  UNITY_END();
+  return 0;
+}
@@ -0,0 +1,167 @@
+#include <unity.h>
+#include <iostream>
+#include "TickTimebase.h"
+
+using namespace std;
+
+#define PPQN 96
+#define ONE_HOUR 3600000000ULL  // us
+
+typedef TickTimebase<PPQN, 40, 189> Timebase;
+
+void setUp(void) {
+  // set stuff up here
+}
+
+void tearDown(void) {
+  // clean stuff up here
+}
+
+// the exact time of the nth tick, in us
+double exactTickTime(uint64_t n, int bpm, int ppqn = PPQN) {
+  return (double)n * 60000000.0 / ((double)bpm * ppqn);
+}
+
+// run one virtual hour, returning the worst difference between a tick time and its exact time
+template <int TICKS_PER_BEAT>
+double worstErrorOverOneHour(int bpm) {
+  TickTimebase<TICKS_PER_BEAT, 40, 189> timebase(bpm);
+  timebase.start(0);
+  uint64_t ticks = 1;
+  double worstError = 0;
+  while (timebase.nextTick < ONE_HOUR) {
+    double error = exactTickTime(ticks, bpm, TICKS_PER_BEAT) - (double)timebase.nextTick;
+    if (error < 0) error = -error;
+    if (error > worstError) worstError = error;
+    timebase.advance();
+    ticks += 1;
+  }
+  return worstError;
+}
+
+void test_interval_and_remainder() {
+  Timebase timebase(120);
+  TEST_ASSERT_EQUAL(5208, timebase.interval);
+  TEST_ASSERT_EQUAL(60000000 - 5208 * 120 * PPQN, timebase.remainder);
+}
+
+void test_one_beat_is_exact() {
+  Timebase timebase(120);
+  timebase.start(0);
+  for (int i = 1; i < PPQN; i++) {
+    timebase.advance();
+  }
+  TEST_ASSERT_EQUAL(500000, (uint32_t)timebase.nextTick);
+}
+
+/**
+ * run one virtual hour at every tempo the pot can select, comparing every tick time against the exact time.
+ * Also print how far the old whole microsecond tick intervals would have drifted over the same hour
+*/
+void test_one_hour_drift() {
+  double worstError = 0;
+  for (int bpm = 40; bpm < 190; bpm++) {
+    Timebase timebase(bpm);
+    uint64_t startTime = 0xFFFFFF00ULL;  // start just before the 32-bit counter would have wrapped
+    timebase.start(startTime);
+    uint64_t ticks = 1;
+    double error = 0;
+    while (timebase.nextTick - startTime < ONE_HOUR) {
+      error = exactTickTime(ticks, bpm) - (double)(timebase.nextTick - startTime);
+      if (error < 0) error = -error;
+      if (error > worstError) worstError = error;
+      timebase.advance();
+      ticks += 1;
+    }
+
+    if (bpm == 120 || bpm == 137) {
+      double oldDrift = exactTickTime(ticks, bpm) - (double)ticks * timebase.interval;
+      cout << bpm << "bpm, " << ticks << " ticks: fractional error " << error << " us, whole us intervals drift " << oldDrift << " us" << endl;
+    }
+  }
+  cout << "worst error after one hour: " << worstError << " us" << endl;
+  TEST_ASSERT_TRUE(worstError < 1.0);
+}
+
+void test_tempo_change_keeps_position() {
+  Timebase timebase(120);
+  timebase.start(1000);
+  uint64_t before = timebase.nextTick;
+  timebase.setTempo(60);
+  TEST_ASSERT_TRUE(before == timebase.nextTick);   // the tick already scheduled does not move
+  timebase.advance();
+  uint64_t length = timebase.nextTick - before;    // 10416.67us, plus whatever fraction was carried over
+  TEST_ASSERT_TRUE(length == 10416 || length == 10417);
+}
+
+void test_glide_walks_one_bpm_at_a_time() {
+  Timebase timebase(120);
+  timebase.glideTicks = 2;
+  timebase.start(0);
+  timebase.glideTo(117);
+  TEST_ASSERT_EQUAL(120, timebase.bpm);
+  for (int i = 0; i < 2; i++) timebase.advance();
+  TEST_ASSERT_EQUAL(119, timebase.bpm);
+  for (int i = 0; i < 4; i++) timebase.advance();
+  TEST_ASSERT_EQUAL(117, timebase.bpm);
+  for (int i = 0; i < 10; i++) timebase.advance();
+  TEST_ASSERT_EQUAL(117, timebase.bpm);
+}
+
+void test_tempo_change_keeps_fraction() {
+  Timebase timebase(137);
+  timebase.start(0);
+  for (int i = 0; i < 100; i++) timebase.advance();
+  uint32_t fraction = timebase.remainderAcc;        // in 1/(137*96) us
+  timebase.setTempo(68);                            // half the denominator, roughly
+  TEST_ASSERT_EQUAL(fraction * 68 / 137, timebase.remainderAcc);
+}
+
+void test_table_matches_division() {
+  for (int bpm = 40; bpm <= 189; bpm++) {
+    TEST_ASSERT_EQUAL(60000000 / (bpm * PPQN), Timebase::table.interval[bpm - 40]);
+    TEST_ASSERT_EQUAL(60000000 % (bpm * PPQN), Timebase::table.remainder[bpm - 40]);
+  }
+}
+
+void test_tempo_is_clamped_to_range() {
+  Timebase timebase(120);
+  timebase.setTempo(20);
+  TEST_ASSERT_EQUAL(40, timebase.bpm);
+  timebase.setTempo(250);
+  TEST_ASSERT_EQUAL(189, timebase.bpm);
+}
+
+void test_every_resolution_is_drift_free() {
+  int tempos[4] = { 40, 97, 120, 189 };
+  for (int i = 0; i < 4; i++) {
+    TEST_ASSERT_TRUE(worstErrorOverOneHour<24>(tempos[i]) < 1.0);
+    TEST_ASSERT_TRUE(worstErrorOverOneHour<48>(tempos[i]) < 1.0);
+    TEST_ASSERT_TRUE(worstErrorOverOneHour<192>(tempos[i]) < 1.0);
+  }
+}
+
+void test_wrap_counter() {
+  WrapCounter counter;
+  TEST_ASSERT_TRUE(counter.extend(0xFFFFFFF0) == 0xFFFFFFF0ULL);
+  TEST_ASSERT_TRUE(counter.extend(0x00000010) == 0x100000010ULL);
+  TEST_ASSERT_TRUE(counter.extend(0x00000010) == 0x100000010ULL);
+  TEST_ASSERT_TRUE(counter.extend(0x80000000) == 0x180000000ULL);
+  TEST_ASSERT_TRUE(counter.extend(0x00000000) == 0x200000000ULL);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_interval_and_remainder);
+  RUN_TEST(test_one_beat_is_exact);
+  RUN_TEST(test_one_hour_drift);
+  RUN_TEST(test_tempo_change_keeps_position);
+  RUN_TEST(test_glide_walks_one_bpm_at_a_time);
+  RUN_TEST(test_tempo_change_keeps_fraction);
+  RUN_TEST(test_table_matches_division);
+  RUN_TEST(test_tempo_is_clamped_to_range);
+  RUN_TEST(test_every_resolution_is_drift_free);
+  RUN_TEST(test_wrap_counter);
+  UNITY_END();
+  return 0;
+}
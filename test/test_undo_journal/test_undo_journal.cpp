@@ -0,0 +1,128 @@
+#include <unity.h>
+#include <iostream>
+#include "EventStore.h"
+#include "UndoJournal.h"
+
+using namespace std;
+
+#define MAX_SEQ_EVENTS   256
+#define MAX_UNDO_ENTRIES 16
+
+EventStore<MAX_SEQ_EVENTS> store;
+UndoJournal<MAX_UNDO_ENTRIES> journal;
+
+void setUp(void) {
+  store.clear();
+  journal.clear();
+}
+
+void tearDown(void) {
+  // clean stuff up here
+}
+
+// mirrors TouchChannel::createEvent()
+void createEvent(int position, int noteIndex, bool gate, uint8_t offset = 0) {
+  journal.record(position, store.find(position));
+  SequenceNode *node = store.insert(position);
+  node->noteIndex = noteIndex;
+  node->gate = gate;
+  node->offset = offset;
+}
+
+// mirrors TouchChannel::clearEvent()
+void clearEvent(int position) {
+  SequenceNode *node = store.find(position);
+  if (!node) return;
+  journal.record(position, node);
+  store.remove(position);
+}
+
+void test_undo_new_events() {
+  journal.beginPass();
+  createEvent(10, 1, true);
+  createEvent(20, 1, false);
+
+  TEST_ASSERT_TRUE(journal.undoLastPass(store));
+  TEST_ASSERT_TRUE(store.isEmpty());
+  TEST_ASSERT_FALSE(journal.undoLastPass(store));
+}
+
+void test_undo_restores_overwritten_and_cleared_events() {
+  journal.beginPass();
+  createEvent(10, 1, true, 200);
+  createEvent(20, 1, false);
+  createEvent(30, 2, true);
+
+  journal.beginPass();               // overdub pass
+  createEvent(10, 5, true, 17);      // overwrite
+  clearEvent(20);                    // clear
+  clearEvent(30);
+  createEvent(30, 6, false);         // same position modified twice in a pass
+
+  TEST_ASSERT_TRUE(journal.undoLastPass(store));
+  TEST_ASSERT_EQUAL(3, store.size());
+  TEST_ASSERT_EQUAL(1, store.find(10)->noteIndex);
+  TEST_ASSERT_EQUAL(200, store.find(10)->offset);  // sub-tick timing comes back too
+  TEST_ASSERT_FALSE(store.find(20)->gate);
+  TEST_ASSERT_EQUAL(2, store.find(30)->noteIndex);
+  TEST_ASSERT_TRUE(store.find(30)->gate);
+
+  TEST_ASSERT_TRUE(journal.undoLastPass(store)); // and the pass before that
+  TEST_ASSERT_TRUE(store.isEmpty());
+}
+
+void test_empty_passes_are_free() {
+  journal.beginPass();
+  createEvent(10, 1, true);
+  for (int i = 0; i < 100; i++) {
+    journal.beginPass();             // loop wraps without any edits
+  }
+  TEST_ASSERT_EQUAL(1, journal.size());
+  TEST_ASSERT_TRUE(journal.undoLastPass(store));
+  TEST_ASSERT_TRUE(store.isEmpty());
+}
+
+void test_full_journal_drops_oldest_pass() {
+  journal.beginPass();
+  for (int i = 0; i < 10; i++) createEvent(i, 1, true);
+  journal.beginPass();
+  for (int i = 10; i < 20; i++) createEvent(i, 2, true);  // does not fit alongside the first pass
+
+  TEST_ASSERT_EQUAL(10, journal.size());
+  TEST_ASSERT_TRUE(journal.undoLastPass(store));
+  TEST_ASSERT_EQUAL(10, store.size());                     // the second pass is undone
+  TEST_ASSERT_FALSE(journal.undoLastPass(store));          // the first pass is gone
+  TEST_ASSERT_EQUAL(10, store.size());
+}
+
+void test_pass_larger_than_journal_can_not_be_undone() {
+  journal.beginPass();
+  createEvent(100, 1, true);
+  journal.beginPass();
+  for (int i = 0; i < MAX_UNDO_ENTRIES + 4; i++) createEvent(i, 2, true);
+
+  TEST_ASSERT_FALSE(journal.undoLastPass(store));
+  TEST_ASSERT_EQUAL(MAX_UNDO_ENTRIES + 5, store.size());
+
+  journal.beginPass();                                     // the journal recovers on the next pass
+  createEvent(200, 3, true);
+  TEST_ASSERT_TRUE(journal.undoLastPass(store));
+  TEST_ASSERT_NULL(store.find(200));
+}
+
+void test_memory_footprint() {
+  cout << "UndoJournal<" << MAX_UNDO_ENTRIES << ">: " << sizeof(journal) << " bytes" << endl;
+}
+
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_undo_new_events);
+    RUN_TEST(test_undo_restores_overwritten_and_cleared_events);
+    RUN_TEST(test_empty_passes_are_free);
+    RUN_TEST(test_full_journal_drops_oldest_pass);
+    RUN_TEST(test_pass_larger_than_journal_can_not_be_undone);
+    RUN_TEST(test_memory_footprint);
+    UNITY_END();
+    return 0;
+}